@@ -0,0 +1,11 @@
+# Builds the engine library first, and then the visualizer and the tester that link it.
+
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    engine \
+    src \
+    HeatMapTester
+
+src.depends = engine
+HeatMapTester.depends = engine
@@ -1,11 +1,28 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <thread>
 #include <QDir>
+#include <QEventLoop>
+#include <QProcess>
 #include <QTextStream>
 #include <QVector>
 #include <QFile>
 
-#include "HeatMapModel.h"
+#include "AutoTuner.h"
+#include "BinaryGridFile.h"
+#include "FileHandler.h"
+#include "GenerationBarrier.h"
+#include "HaloExchange.h"
+#include "HeatMapEngine.h"
 #include "HeatMapTester.h"
+#include "HeatMapWorker.h"
+#include "OutOfCoreSimulation.h"
+#include "SocketTransport.h"
+#include "StencilKernel.h"
+#include "TemperatureGrid.h"
 
 #define FLOAT_EQUALS(x,y)\
         (abs(x-y) < outputRangeDifference)
@@ -13,17 +30,36 @@
 HeatMapTester::HeatMapTester(int &argc, char **argv)
     : QCoreApplication(argc, argv)
 {
-    this->heatMapModel = new HeatMapModel(this);
+    this->engine = new HeatMapEngine();
+    this->fileHandler = new FileHandler();
+    this->outputMatrix = new TemperatureGrid();
+    this->autoTuner = new AutoTuner();
+    this->autoTuner->loadProfile( AutoTuner::getDefaultProfilePath() );
 }
 
 HeatMapTester::~HeatMapTester()
 {
-    delete this->heatMapModel;
+    delete this->autoTuner;
+    delete this->outputMatrix;
+    delete this->fileHandler;
+    delete this->engine;
 }
 
 int HeatMapTester::printHelp()
 {
-    std::cout << "Usage: HeatMapTester <TEST DIRECTORY>\n";
+    std::cout << "Usage: HeatMapTester [--solver jacobi|red-black|sor|multigrid|direct|cg|async|all] [--omega <FACTOR>|adaptive] [--cycle v|w|fmg] [--preconditioner jacobi|ssor|ic] [--tile <HEIGHT>x<WIDTH>] [--temporal <GENERATIONS>] [--decomposition rows|blocks] [--no-steal] [--placement loader|first-touch|interleave] [--affinity compact|scatter|<CPU>,...] [--no-profile] <TEST DIRECTORY>\n"
+              << "       HeatMapTester --autotune ROWS COLUMNS\n"
+              << "       HeatMapTester --benchmark-kernels [ROWS COLUMNS]\n"
+              << "       HeatMapTester --benchmark-tiles [ROWS COLUMNS TILE_HEIGHT TILE_WIDTH]\n"
+              << "       HeatMapTester --benchmark-handoff [WORKERS GENERATIONS]\n"
+              << "       HeatMapTester --benchmark-scaling [CELLS THREADS]\n"
+              << "       HeatMapTester --benchmark-async [CELLS THREADS EPSILON]\n"
+              << "       HeatMapTester --benchmark-distributed [CELLS PROCESSES EPSILON]\n"
+              << "       HeatMapTester --benchmark-stop [CELLS STOPS]\n"
+              << "       HeatMapTester --benchmark-load FILE\n"
+              << "       HeatMapTester --convert INPUT OUTPUT [float64|float32]\n"
+              << "       HeatMapTester --out-of-core INPUT.grid OUTPUT.grid EPSILON [BAND_ROWS]\n"
+              << "       HeatMapTester --checkpoint INPUT CHECKPOINT EPSILON [INTERVAL_SECONDS]\n";
     return EXIT_FAILURE;
 }
 
@@ -32,12 +68,832 @@ int HeatMapTester::run()
     if ( this->arguments().count() <= 1 )
         return printHelp();
 
+    if ( this->arguments()[1] == "--benchmark-kernels" )
+        return this->benchmarkKernels();
+    if ( this->arguments()[1] == "--benchmark-tiles" )
+        return this->benchmarkTiles();
+    if ( this->arguments()[1] == "--benchmark-handoff" )
+        return this->benchmarkHandoff();
+    if ( this->arguments()[1] == "--benchmark-scaling" )
+        return this->benchmarkScaling();
+    if ( this->arguments()[1] == "--benchmark-async" )
+        return this->benchmarkAsynchronous();
+    if ( this->arguments()[1] == "--benchmark-distributed" )
+        return this->benchmarkDistributed();
+    if ( this->arguments()[1] == "--benchmark-stop" )
+        return this->benchmarkStop();
+    if ( this->arguments()[1] == "--benchmark-load" )
+        return this->benchmarkLoad();
+    if ( this->arguments()[1] == "--convert" )
+        return this->convert();
+    if ( this->arguments()[1] == "--out-of-core" )
+        return this->runOutOfCore();
+    if ( this->arguments()[1] == "--checkpoint" )
+        return this->runCheckpointed();
+    if ( this->arguments()[1] == "--autotune" )
+        return this->autotune();
+    if ( this->arguments()[1] == DISTRIBUTED_RANK_OPTION )
+        return this->runDistributedRank();
+
+    // Without --solver, every directory is tested with the default one.
+    std::vector<Solver> solvers = { this->engine->getSolver() };
+
     for ( int index = 1; index < this->arguments().count(); ++index )
-        this->testDirectory( this->arguments()[index]);
+    {
+        if ( this->arguments()[index] == "--solver" )
+        {
+            if ( index + 1 >= this->arguments().count() )
+                return printHelp();
+            const QString solverName = this->arguments()[++index];
+            solvers.clear();
+            for ( int solver = JACOBI_SOLVER; solver < SOLVER_COUNT; ++solver )
+                if ( solverName == "all" || solverName == getSolverName(static_cast<Solver>(solver)) )
+                    solvers.push_back( static_cast<Solver>(solver) );
+            if ( solvers.empty() )
+                return printHelp();
+        }
+        else if ( this->arguments()[index] == "--omega" )
+        {
+            if ( index + 1 >= this->arguments().count() )
+                return printHelp();
+            const QString factor = this->arguments()[++index];
+            this->engine->setAdaptiveRelaxation( factor == "adaptive" );
+            if ( factor != "adaptive" )
+                this->engine->setRelaxationFactor( factor.toDouble() );
+        }
+        else if ( this->arguments()[index] == "--cycle" )
+        {
+            if ( index + 1 >= this->arguments().count() )
+                return printHelp();
+            const QString cycleName = this->arguments()[++index];
+            int cycle = MultigridSolver::V_CYCLE;
+            while ( cycle < MultigridSolver::CYCLE_COUNT && cycleName != MultigridSolver::getCycleName(static_cast<MultigridSolver::Cycle>(cycle)) )
+                ++cycle;
+            if ( cycle == MultigridSolver::CYCLE_COUNT )
+                return printHelp();
+            this->engine->setMultigridCycle( static_cast<MultigridSolver::Cycle>(cycle) );
+        }
+        else if ( this->arguments()[index] == "--preconditioner" )
+        {
+            if ( index + 1 >= this->arguments().count() )
+                return printHelp();
+            const QString preconditionerName = this->arguments()[++index];
+            int preconditioner = ConjugateGradientSolver::JACOBI_PRECONDITIONER;
+            while ( preconditioner < ConjugateGradientSolver::PRECONDITIONER_COUNT
+                    && preconditionerName != ConjugateGradientSolver::getPreconditionerName(static_cast<ConjugateGradientSolver::Preconditioner>(preconditioner)) )
+                ++preconditioner;
+            if ( preconditioner == ConjugateGradientSolver::PRECONDITIONER_COUNT )
+                return printHelp();
+            this->engine->setPreconditioner( static_cast<ConjugateGradientSolver::Preconditioner>(preconditioner) );
+        }
+        else if ( this->arguments()[index] == "--tile" )
+        {
+            const QStringList tileShape = index + 1 < this->arguments().count() ? this->arguments()[++index].split('x') : QStringList();
+            if ( tileShape.count() != 2 )
+                return printHelp();
+            this->engine->setTileShape( tileShape.at(0).toULongLong(), tileShape.at(1).toULongLong() );
+            // The profile would replace the tile shape that was asked for.
+            this->tuningProfile = false;
+        }
+        else if ( this->arguments()[index] == "--temporal" )
+        {
+            if ( index + 1 >= this->arguments().count() )
+                return printHelp();
+            this->engine->setTemporalBlocking( this->arguments()[++index].toULongLong() );
+        }
+        else if ( this->arguments()[index] == "--decomposition" )
+        {
+            if ( index + 1 >= this->arguments().count() )
+                return printHelp();
+            const QString decompositionName = this->arguments()[++index];
+            int decomposition = TileScheduler::ROW_STRIPES;
+            while ( decomposition < TileScheduler::DECOMPOSITION_COUNT
+                    && decompositionName != TileScheduler::getDecompositionName(static_cast<TileScheduler::Decomposition>(decomposition)) )
+                ++decomposition;
+            if ( decomposition == TileScheduler::DECOMPOSITION_COUNT )
+                return printHelp();
+            this->engine->setDecomposition( static_cast<TileScheduler::Decomposition>(decomposition) );
+        }
+        else if ( this->arguments()[index] == "--no-profile" )
+        {
+            this->tuningProfile = false;
+        }
+        else if ( this->arguments()[index] == "--no-steal" )
+        {
+            this->engine->setWorkStealing(false);
+        }
+        else if ( this->arguments()[index] == "--placement" )
+        {
+            if ( index + 1 >= this->arguments().count() )
+                return printHelp();
+            const QString placementName = this->arguments()[++index];
+            int placement = NumaTopology::LOADER_PLACEMENT;
+            while ( placement < NumaTopology::PLACEMENT_COUNT && placementName != NumaTopology::getPlacementName(static_cast<NumaTopology::Placement>(placement)) )
+                ++placement;
+            if ( placement == NumaTopology::PLACEMENT_COUNT )
+                return printHelp();
+            this->engine->setMemoryPlacement( static_cast<NumaTopology::Placement>(placement) );
+        }
+        else if ( this->arguments()[index] == "--affinity" )
+        {
+            if ( index + 1 >= this->arguments().count() )
+                return printHelp();
+            const QString affinity = this->arguments()[++index];
+            std::vector<int> cpus;
+            if ( affinity == "compact" )
+                cpus = NumaTopology::getCompactCpus();
+            else if ( affinity == "scatter" )
+                cpus = NumaTopology::getScatterCpus();
+            else
+            {
+                for ( const QString& cpu : affinity.split(',') )
+                {
+                    bool valid = false;
+                    cpus.push_back( cpu.toInt(&valid) );
+                    if ( !valid )
+                        return printHelp();
+                }
+            }
+            this->engine->setCpuAffinity(cpus);
+        }
+        else
+        {
+            for ( Solver solver : solvers )
+            {
+                this->engine->setSolver(solver);
+                this->testDirectory( this->arguments()[index]);
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+int HeatMapTester::benchmarkKernels()
+{
+    size_t rows = 1024;
+    size_t columns = 1024;
+    if ( this->arguments().count() > 3 )
+    {
+        rows = this->arguments()[2].toULongLong();
+        columns = this->arguments()[3].toULongLong();
+    }
+
+    std::cout << "Dispatcher selected the " << StencilKernel::getVariantName( StencilKernel::getSelectedVariant() ) << " kernel" << std::endl;
+    StencilKernel::reportThroughput(std::cout, rows, columns, 100);
+    return EXIT_SUCCESS;
+}
+
+int HeatMapTester::benchmarkTiles()
+{
+    size_t rows = 2048;
+    size_t columns = 16384;
+    size_t tileHeight = 32;
+    size_t tileWidth = 512;
+    if ( this->arguments().count() > 5 )
+    {
+        rows = this->arguments()[2].toULongLong();
+        columns = this->arguments()[3].toULongLong();
+        tileHeight = this->arguments()[4].toULongLong();
+        tileWidth = this->arguments()[5].toULongLong();
+    }
+    if ( rows < 3 || columns < 3 )
+        return printHelp();
+
+    const int workerCount = qMin( QThread::idealThreadCount(), static_cast<int>(rows - 2) );
+    const size_t generations = 20;
+    const double interiorCells = static_cast<double>(rows - 2) * static_cast<double>(columns - 2);
+
+    TemperatureGrid previous(rows, columns, 100.0);
+    TemperatureGrid current(previous);
+
+    std::cout << "Tiled sweep on a " << rows << "x" << columns << " matrix, " << workerCount << " workers, " << generations << " generations:\n";
+
+    const double stripeSeconds = this->timeSweeps(previous, current, workerCount, 0, 0, generations);
+    const double tileSeconds = this->timeSweeps(previous, current, workerCount, tileHeight, tileWidth, generations);
+
+    std::cout << "  rows:  " << interiorCells * generations / stripeSeconds << " cells/s, "
+              << StencilKernel::getBytesPerCell(1, columns - 2) << " bytes/cell\n";
+    std::cout << "  tiles " << tileHeight << "x" << tileWidth << ": " << interiorCells * generations / tileSeconds << " cells/s, "
+              << StencilKernel::getBytesPerCell(tileHeight, tileWidth) << " bytes/cell\n";
+    std::cout << "  speedup: " << stripeSeconds / tileSeconds << "x" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int HeatMapTester::benchmarkHandoff()
+{
+    int workerCount = QThread::idealThreadCount();
+    size_t generations = 20000;
+    if ( this->arguments().count() > 3 )
+    {
+        workerCount = this->arguments()[2].toInt();
+        generations = this->arguments()[3].toULongLong();
+    }
+    if ( workerCount < 1 || generations == 0 )
+        return printHelp();
+
+    std::cout << "Generation handoff with " << workerCount << " workers, " << generations << " generations:\n";
+
+    // The pool: every worker meets the others at the barrier, and the last one to arrive decides whether to go on.
+    GenerationBarrier barrier;
+    size_t barrierGeneration = 0;
+    barrier.reset( workerCount, [&barrierGeneration, generations]() { return ++barrierGeneration < generations; } );
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::thread> poolWorkers;
+    for ( int workerId = 0; workerId < workerCount; ++workerId )
+        poolWorkers.emplace_back( [&barrier]() { while ( barrier.arriveAndWait() ); } );
+    for ( std::thread& worker : poolWorkers )
+        worker.join();
+    const std::chrono::duration<double> barrierSeconds = std::chrono::steady_clock::now() - start;
+
+    // The signal path: a queued call into the event loop of every worker, which queues a reply back to the model.
+    std::vector<QThread*> signalWorkers;
+    std::vector<QObject*> workerContexts;
+    for ( int workerId = 0; workerId < workerCount; ++workerId )
+    {
+        signalWorkers.push_back( new QThread() );
+        workerContexts.push_back( new QObject() );
+        workerContexts.back()->moveToThread( signalWorkers.back() );
+        signalWorkers.back()->start();
+    }
+    QEventLoop modelLoop;
+    QObject modelContext;
+    size_t signalGeneration = 0;
+    int finishedWorkerCount = 0;
+    std::function<void()> updateMatrix;
+    const std::function<void()> temperatureUpdateDone = [&]()
+    {
+        if ( ++finishedWorkerCount < workerCount )
+            return;
+        finishedWorkerCount = 0;
+        if ( ++signalGeneration < generations )
+            updateMatrix();
+        else
+            modelLoop.quit();
+    };
+    updateMatrix = [&]()
+    {
+        for ( QObject* workerContext : workerContexts )
+            QMetaObject::invokeMethod( workerContext, [&]() { QMetaObject::invokeMethod(&modelContext, temperatureUpdateDone, Qt::QueuedConnection); }, Qt::QueuedConnection );
+    };
+    start = std::chrono::steady_clock::now();
+    updateMatrix();
+    modelLoop.exec();
+    const std::chrono::duration<double> signalSeconds = std::chrono::steady_clock::now() - start;
+
+    for ( int workerId = 0; workerId < workerCount; ++workerId )
+    {
+        signalWorkers[workerId]->quit();
+        signalWorkers[workerId]->wait();
+        delete workerContexts[workerId];
+        delete signalWorkers[workerId];
+    }
+
+    std::cout << "  barrier: " << barrierSeconds.count() / generations * 1e6 << " us per generation\n";
+    std::cout << "  signals: " << signalSeconds.count() / generations * 1e6 << " us per generation\n";
+    std::cout << "  speedup: " << signalSeconds.count() / barrierSeconds.count() << "x" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int HeatMapTester::benchmarkScaling()
+{
+    size_t cells = 1024 * 1024;
+    int maximumThreads = QThread::idealThreadCount();
+    if ( this->arguments().count() > 3 )
+    {
+        cells = this->arguments()[2].toULongLong();
+        maximumThreads = this->arguments()[3].toInt();
+    }
+    if ( cells < 64 || maximumThreads < 1 )
+        return printHelp();
+
+    // The three shapes have the same interior cells, so only the decomposition changes their throughput.
+    const size_t side = static_cast<size_t>( std::sqrt( static_cast<double>(cells) ) );
+    const std::vector< std::pair<const char*, std::pair<size_t, size_t>> > shapes =
+    {
+        { "square", { side, side } },
+        { "wide", { side / 8, side * 8 } },
+        { "tall", { side * 8, side / 8 } }
+    };
+    const size_t generations = 20;
+
+    for ( const auto& shape : shapes )
+    {
+        const size_t interiorRows = shape.second.first;
+        const size_t interiorColumns = shape.second.second;
+        TemperatureGrid previous(interiorRows + 2, interiorColumns + 2, 100.0);
+        TemperatureGrid current(previous);
+        const double interiorCells = static_cast<double>(interiorRows) * static_cast<double>(interiorColumns);
+
+        std::cout << "Jacobi scaling on a " << shape.first << " " << interiorRows << "x" << interiorColumns << " interior, " << generations << " generations:\n";
+        double baseSeconds[TileScheduler::DECOMPOSITION_COUNT] = {};
+        for ( int threads = 1; threads <= maximumThreads; ++threads )
+        {
+            std::cout << "  " << threads << " threads:";
+            for ( int decomposition = TileScheduler::ROW_STRIPES; decomposition < TileScheduler::DECOMPOSITION_COUNT; ++decomposition )
+            {
+                int gridRows = threads;
+                int gridColumns = 1;
+                if ( decomposition == TileScheduler::BLOCKS )
+                    TileScheduler::chooseGrid(interiorRows, interiorColumns, threads, gridRows, gridColumns);
+                // Every cut between two blocks makes the workers on both sides read a line of the other one.
+                const double haloCells = 2.0 * ( (gridRows - 1) * static_cast<double>(interiorColumns) + (gridColumns - 1) * static_cast<double>(interiorRows) );
+
+                const double seconds = this->timePool( previous, current, threads, static_cast<TileScheduler::Decomposition>(decomposition), generations );
+                if ( threads == 1 )
+                    baseSeconds[decomposition] = seconds;
+                std::cout << "  " << TileScheduler::getDecompositionName( static_cast<TileScheduler::Decomposition>(decomposition) ) << " " << gridRows << "x" << gridColumns
+                          << ": " << interiorCells * generations / seconds << " cells/s, speedup " << baseSeconds[decomposition] / seconds
+                          << ", halo " << 100.0 * haloCells / interiorCells << "%";
+            }
+            std::cout << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+int HeatMapTester::benchmarkAsynchronous()
+{
+    size_t cells = 128 * 128;
+    int maximumThreads = QThread::idealThreadCount();
+    double epsilon = 1e-4;
+    if ( this->arguments().count() > 3 )
+    {
+        cells = this->arguments()[2].toULongLong();
+        maximumThreads = this->arguments()[3].toInt();
+    }
+    if ( this->arguments().count() > 4 )
+        epsilon = this->arguments()[4].toDouble();
+    if ( cells < 4 || maximumThreads < 1 || epsilon <= 0.0 )
+        return printHelp();
+
+    // The exact equilibrium state of the plate is given by the direct solver.
+    const size_t side = static_cast<size_t>( std::sqrt( static_cast<double>(cells) ) );
+    const TemperatureGrid matrix = makePlate(side);
+    HeatMapEngine engine;
+    engine.loadMatrix(matrix);
+    engine.setSolver(DIRECT_SOLVER);
+    engine.run();
+    const TemperatureGrid exact = engine.getResult();
+
+    std::cout << "Time to equilibrium on a " << side << "x" << side << " interior with epsilon " << epsilon
+              << ", synchronous red-black against asynchronous relaxation:\n";
+    engine.setEpsilon(epsilon);
+    for ( int threads = 1; threads <= maximumThreads; threads = threads < maximumThreads && threads * 2 > maximumThreads ? maximumThreads : threads * 2 )
+    {
+        std::cout << "  " << threads << " threads:";
+        double seconds[2] = {};
+        const Solver solvers[2] = { RED_BLACK_SOLVER, ASYNCHRONOUS_SOLVER };
+        for ( int index = 0; index < 2; ++index )
+        {
+            engine.setSolver(solvers[index]);
+            engine.setThreadCount(threads);
+            engine.loadMatrix(matrix);
+            const bool reached = engine.run();
+            seconds[index] = engine.getSolveSeconds();
+
+            double error = 0.0;
+            const TemperatureGrid& result = engine.getResult();
+            for ( size_t row = 1; row <= side; ++row )
+                for ( size_t column = 1; column <= side; ++column )
+                    error = std::max( error, std::abs( result(row, column) - exact(row, column) ) );
+            std::cout << "  " << getSolverName(solvers[index]) << " " << seconds[index] << " s, " << engine.getGenerationCount()
+                      << ( index == 0 ? " generations" : " sweeps per worker" ) << ", error " << error << ( reached ? "" : " (not reached)" );
+        }
+        std::cout << ", speedup " << seconds[0] / seconds[1] << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
+
+int HeatMapTester::benchmarkDistributed()
+{
+    size_t cells = 128 * 128;
+    int maximumProcesses = QThread::idealThreadCount();
+    double epsilon = 1e-3;
+    if ( this->arguments().count() > 3 )
+    {
+        cells = this->arguments()[2].toULongLong();
+        maximumProcesses = this->arguments()[3].toInt();
+    }
+    if ( this->arguments().count() > 4 )
+        epsilon = this->arguments()[4].toDouble();
+    if ( cells < 4 || maximumProcesses < 1 || epsilon <= 0.0 )
+        return printHelp();
+
+    // Every process simulates its block with a single worker, so the processes take the place of the threads.
+    const size_t side = static_cast<size_t>( std::sqrt( static_cast<double>(cells) ) );
+    // Warm on its right edge too, so no two blocks are alike.
+    const TemperatureGrid matrix = makePlate(side, 50.0);
+    HeatMapEngine engine;
+    engine.setThreadCount(1);
+    engine.setEpsilon(epsilon);
+    engine.loadMatrix(matrix);
+    engine.run();
+    const TemperatureGrid expected = engine.getResult();
+    std::cout << "Distributed Jacobi on a " << side << "x" << side << " interior with epsilon " << epsilon << ", one process: "
+              << engine.getSolveSeconds() << " s, " << engine.getGenerationCount() << " generations\n";
+
+    for ( int processes = 2; processes <= maximumProcesses; processes = processes < maximumProcesses && processes * 2 > maximumProcesses ? maximumProcesses : processes * 2 )
+    {
+        std::cout << "  " << processes << " processes:";
+        for ( int decomposition = TileScheduler::ROW_STRIPES; decomposition < TileScheduler::DECOMPOSITION_COUNT; ++decomposition )
+        {
+            const QString decompositionName = TileScheduler::getDecompositionName( static_cast<TileScheduler::Decomposition>(decomposition) );
+            const QString socketPrefix = QDir::temp().filePath( QString("HeatMapTester-%1-%2-%3").arg( QCoreApplication::applicationPid() ).arg(processes).arg(decompositionName) );
+            const QStringList rankArguments = { QString::number(processes), QString::number(side), QString::number(epsilon, 'g', 17), decompositionName, socketPrefix };
+
+            // This process is the first rank, the others are copies of the tester.
+            std::vector<QProcess*> ranks;
+            for ( int rank = 1; rank < processes; ++rank )
+            {
+                ranks.push_back( new QProcess() );
+                ranks.back()->setProcessChannelMode(QProcess::ForwardedChannels);
+                ranks.back()->start( QCoreApplication::applicationFilePath(), QStringList{ DISTRIBUTED_RANK_OPTION, QString::number(rank) } + rankArguments );
+            }
+            DistributedResult result;
+            TemperatureGrid gathered(matrix);
+            bool succeeded = this->simulateDistributed( 0, processes, epsilon, static_cast<TileScheduler::Decomposition>(decomposition), socketPrefix, gathered, result );
+            for ( QProcess* rank : ranks )
+            {
+                succeeded = rank->waitForFinished(-1) && rank->exitStatus() == QProcess::NormalExit && rank->exitCode() == EXIT_SUCCESS && succeeded;
+                delete rank;
+            }
+            if ( !succeeded )
+            {
+                std::cout << "  " << decompositionName.toStdString() << " failed";
+                continue;
+            }
+
+            double difference = 0.0;
+            for ( size_t row = 1; row <= side; ++row )
+                for ( size_t column = 1; column <= side; ++column )
+                    difference = std::max( difference, std::abs( gathered(row, column) - expected(row, column) ) );
+            std::cout << "  " << decompositionName.toStdString() << " " << result.seconds << " s, compute " << result.computeSeconds
+                      << " s, communication " << result.communicationSeconds << " s, " << result.generationCount << " generations, difference " << difference;
+        }
+        std::cout << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
+
+int HeatMapTester::benchmarkStop()
+{
+    size_t cells = 256 * 256;
+    int stops = 5;
+    if ( this->arguments().count() > 3 )
+    {
+        cells = this->arguments()[2].toULongLong();
+        stops = this->arguments()[3].toInt();
+    }
+    if ( cells < 4 || stops < 1 )
+        return printHelp();
 
+    // The plate is solved once without interruptions and once stopped and resumed.
+    const size_t side = static_cast<size_t>( std::sqrt( static_cast<double>(cells) ) );
+    const TemperatureGrid matrix = makePlate(side);
+    const double epsilon = 1e-4;
+
+    std::cout << "Stop latency on a " << side << "x" << side << " interior, stopping every simulation " << stops << " times and resuming it:\n";
+    for ( int solver = JACOBI_SOLVER; solver < SOLVER_COUNT; ++solver )
+    {
+        // The direct solver cannot be stopped.
+        if ( solver == DIRECT_SOLVER )
+            continue;
+        HeatMapEngine engine;
+        engine.setSolver( static_cast<Solver>(solver) );
+        engine.setEpsilon(epsilon);
+        engine.loadMatrix(matrix);
+        engine.run();
+        const TemperatureGrid expected = engine.getResult();
+        const size_t expectedGenerations = engine.getGenerationCount();
+        const double expectedSeconds = engine.getSolveSeconds();
+
+        // A stop requested while no run is in flight, as when Stop is clicked once the simulation ended, is dropped.
+        engine.stop();
+        engine.loadMatrix(matrix);
+        const bool idleStopDropped = engine.run() && engine.getGenerationCount() == expectedGenerations;
+
+        // Every stop comes a fraction of the uninterrupted run after the start or the last resume.
+        engine.loadMatrix(matrix);
+        const std::chrono::duration<double> interval( expectedSeconds / (stops + 1) );
+        double worstLatency = 0.0;
+        double totalLatency = 0.0;
+        int stopCount = 0;
+        bool reached = false;
+        for ( int stop = 0; stop < stops && !reached; ++stop )
+        {
+            std::thread stopper( [&engine, interval]() { std::this_thread::sleep_for(interval); engine.stop(); } );
+            reached = engine.run();
+            stopper.join();
+            if ( !reached )
+            {
+                ++stopCount;
+                worstLatency = std::max( worstLatency, engine.getStopLatency() );
+                totalLatency += engine.getStopLatency();
+            }
+        }
+        if ( !reached )
+            reached = engine.run();
+
+        double difference = 0.0;
+        const TemperatureGrid& result = engine.getResult();
+        for ( size_t row = 1; row <= side; ++row )
+            for ( size_t column = 1; column <= side; ++column )
+                difference = std::max( difference, std::abs( result(row, column) - expected(row, column) ) );
+        std::cout << "  " << getSolverName( static_cast<Solver>(solver) ) << ": " << stopCount << " stops, latency "
+                  << ( stopCount > 0 ? totalLatency / stopCount * 1e3 : 0.0 ) << " ms on average and " << worstLatency * 1e3 << " ms at most, "
+                  << engine.getGenerationCount() << " generations against " << expectedGenerations << ", difference " << difference
+                  << ( reached ? "" : " (not reached)" ) << ", stop between runs " << ( idleStopDropped ? "dropped" : "stopped the next one" ) << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
+
+int HeatMapTester::benchmarkLoad()
+{
+    if ( this->arguments().count() <= 2 )
+        return printHelp();
+    const QString filePath = this->arguments()[2];
+    const int maximumThreads = QThread::idealThreadCount();
+
+    // The first load brings the file into the page cache, so every measured one reads it from memory.
+    TemperatureGrid matrix;
+    if ( !this->fileHandler->processFile(filePath.toStdString(), matrix) )
+    {
+        std::cerr << "error: HeatMapTester: Could not open file " << qPrintable(filePath) << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Loading " << qPrintable(filePath) << ", " << matrix.getNumberOfRows() << "x" << matrix.getNumberOfColumns()
+              << ", ragged rows: " << this->fileHandler->getLastRaggedRowCount() << ":\n";
+    double baseThroughput = 0.0;
+    for ( int threads = 1; threads <= maximumThreads; threads = threads < maximumThreads && threads * 2 > maximumThreads ? maximumThreads : threads * 2 )
+    {
+        this->fileHandler->setThreadCount(threads);
+        this->fileHandler->processFile(filePath.toStdString(), matrix);
+        const double throughput = this->fileHandler->getLastThroughput();
+        if ( threads == 1 )
+            baseThroughput = throughput;
+        std::cout << "  " << threads << " threads: " << throughput << " MB/s, speedup " << throughput / baseThroughput << std::endl;
+        if ( threads == maximumThreads )
+            break;
+    }
+    this->fileHandler->setThreadCount(0);
+    return EXIT_SUCCESS;
+}
+
+int HeatMapTester::convert()
+{
+    if ( this->arguments().count() <= 3 )
+        return printHelp();
+    const QString inputPath = this->arguments()[2];
+    const QString outputPath = this->arguments()[3];
+    int dataType = BinaryGridFile::FLOAT64;
+    if ( this->arguments().count() > 4 )
+    {
+        while ( dataType < BinaryGridFile::DATA_TYPE_COUNT && this->arguments()[4] != BinaryGridFile::getDataTypeName(static_cast<BinaryGridFile::DataType>(dataType)) )
+            ++dataType;
+        if ( dataType == BinaryGridFile::DATA_TYPE_COUNT )
+            return printHelp();
+    }
+
+    // Every cell is read to be converted anyway, so a damaged binary input is caught for free.
+    TemperatureGrid matrix;
+    this->fileHandler->setChecksumVerification(true);
+    if ( !this->fileHandler->processFile(inputPath.toStdString(), matrix) )
+    {
+        std::cerr << "error: HeatMapTester: Could not open file " << qPrintable(inputPath) << std::endl;
+        return EXIT_FAILURE;
+    }
+    if ( !this->fileHandler->saveFile(outputPath.toStdString(), matrix, static_cast<BinaryGridFile::DataType>(dataType)) )
+    {
+        std::cerr << "error: HeatMapTester: Could not write file " << qPrintable(outputPath) << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Converted " << qPrintable(inputPath) << ", " << matrix.getNumberOfRows() << "x" << matrix.getNumberOfColumns() << " loaded at "
+              << this->fileHandler->getLastThroughput() << " MB/s, to " << qPrintable(outputPath) << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int HeatMapTester::runOutOfCore()
+{
+    if ( this->arguments().count() <= 4 )
+        return printHelp();
+    const QString inputPath = this->arguments()[2];
+    const QString outputPath = this->arguments()[3];
+
+    OutOfCoreSimulation simulation;
+    simulation.setEpsilon( this->arguments()[4].toDouble() );
+    if ( this->arguments().count() > 5 )
+        simulation.setBandRows( this->arguments()[5].toULongLong() );
+    if ( !simulation.open(inputPath.toStdString(), outputPath.toStdString()) )
+    {
+        std::cerr << "error: HeatMapTester: Could not open binary grid file " << qPrintable(inputPath) << std::endl;
+        return EXIT_FAILURE;
+    }
+    const size_t rows = simulation.getNumberOfRows();
+    const size_t columns = simulation.getNumberOfColumns();
+    std::cout << "Simulating " << qPrintable(inputPath) << ", " << rows << "x" << columns << ", in bands of " << simulation.getBandRows()
+              << " rows, window of " << simulation.getWindowBytes() / 1048576.0 << " MB" << std::endl;
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const bool reached = simulation.run();
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    const double interiorCells = static_cast<double>( rows > 2 ? rows - 2 : 0 ) * static_cast<double>( columns > 2 ? columns - 2 : 0 );
+    std::cout << "  " << simulation.getGenerationCount() << " generations in " << seconds << " s, "
+              << ( seconds > 0.0 ? interiorCells * simulation.getGenerationCount() / seconds : 0.0 ) << " cells/s"
+              << ( reached ? "" : " (not reached)" ) << std::endl;
+    if ( !simulation.save() )
+    {
+        std::cerr << "error: HeatMapTester: Could not write file " << qPrintable(outputPath) << std::endl;
+        return EXIT_FAILURE;
+    }
+    return reached ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int HeatMapTester::runCheckpointed()
+{
+    if ( this->arguments().count() <= 4 )
+        return printHelp();
+    const QString inputPath = this->arguments()[2];
+    const QString checkpointPath = this->arguments()[3];
+    const double interval = this->arguments().count() > 5 ? this->arguments()[5].toDouble() : CHECKPOINT_DEFAULT_INTERVAL;
+
+    // The checkpoint keeps the epsilon and the solver of the run that wrote it.
+    HeatMapEngine engine;
+    if ( QFile::exists(checkpointPath) )
+    {
+        if ( !engine.loadCheckpoint(checkpointPath.toStdString()) )
+        {
+            std::cerr << "error: HeatMapTester: Could not read checkpoint " << qPrintable(checkpointPath) << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "Resuming " << qPrintable(checkpointPath) << " from generation " << engine.getGenerationCount() << std::endl;
+    }
+    else
+    {
+        if ( !engine.loadFile(inputPath.toStdString()) )
+        {
+            std::cerr << "error: HeatMapTester: Could not open file " << qPrintable(inputPath) << std::endl;
+            return EXIT_FAILURE;
+        }
+        engine.setEpsilon( this->arguments()[4].toDouble() );
+        std::cout << "Simulating " << qPrintable(inputPath) << ", " << engine.getNumberOfRows() << "x" << engine.getNumberOfColumns() << std::endl;
+    }
+    engine.setCheckpointing(checkpointPath.toStdString(), interval);
+
+    const bool reached = engine.run();
+    if ( !engine.saveCheckpoint() )
+    {
+        std::cerr << "error: HeatMapTester: Could not write checkpoint " << qPrintable(checkpointPath) << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "  " << engine.getGenerationCount() << " generations in " << engine.getSolveSeconds() << " s"
+              << ( reached ? "" : " (not reached)" ) << ", written to " << qPrintable(checkpointPath) << std::endl;
+    return reached ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int HeatMapTester::autotune()
+{
+    if ( this->arguments().count() < 4 )
+        return printHelp();
+    const size_t rows = this->arguments()[2].toULongLong();
+    const size_t columns = this->arguments()[3].toULongLong();
+    if ( rows < 3 || columns < 3 )
+        return printHelp();
+
+    std::cout << "Tuning the simulation of a " << rows << "x" << columns << " matrix:" << std::endl;
+    const AutoTuner::Configuration configuration = this->autoTuner->tune(rows, columns, &std::cout);
+    std::cout << "Fastest: " << StencilKernel::getVariantName(configuration.variant) << ", " << configuration.threadCount << " threads, tile "
+              << configuration.tileHeight << "x" << configuration.tileWidth << ", " << configuration.cellsPerSecond << " cells/s" << std::endl;
+
+    const std::string profilePath = AutoTuner::getDefaultProfilePath();
+    if ( !this->autoTuner->saveProfile(profilePath) )
+    {
+        std::cerr << "error: HeatMapTester: Could not write the profile " << profilePath << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Saved in " << profilePath << std::endl;
     return EXIT_SUCCESS;
 }
 
+int HeatMapTester::runDistributedRank()
+{
+    if ( this->arguments().count() < 8 )
+        return printHelp();
+    const int rank = this->arguments()[2].toInt();
+    const int processes = this->arguments()[3].toInt();
+    const size_t side = this->arguments()[4].toULongLong();
+    const double epsilon = this->arguments()[5].toDouble();
+    const QString decompositionName = this->arguments()[6];
+    int decomposition = TileScheduler::ROW_STRIPES;
+    while ( decomposition < TileScheduler::DECOMPOSITION_COUNT && decompositionName != TileScheduler::getDecompositionName( static_cast<TileScheduler::Decomposition>(decomposition) ) )
+        ++decomposition;
+    if ( rank < 1 || rank >= processes || decomposition == TileScheduler::DECOMPOSITION_COUNT )
+        return printHelp();
+
+    TemperatureGrid matrix = makePlate(side, 50.0);
+    DistributedResult result;
+    const bool succeeded = this->simulateDistributed( rank, processes, epsilon, static_cast<TileScheduler::Decomposition>(decomposition), this->arguments()[7], matrix, result );
+    return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+bool HeatMapTester::simulateDistributed(int rank, int processes, double epsilon, TileScheduler::Decomposition decomposition, const QString& socketPrefix, TemperatureGrid& matrix, DistributedResult& result)
+{
+    SocketTransport transport(socketPrefix.toStdString(), rank, processes);
+    if ( !transport.connect(DISTRIBUTED_CONNECT_SECONDS) )
+    {
+        std::cerr << "Rank " << rank << " could not connect to the other processes" << std::endl;
+        return false;
+    }
+    HaloExchange haloExchange(&transport);
+    if ( !haloExchange.setup(matrix.getNumberOfRows(), matrix.getNumberOfColumns(), decomposition) )
+    {
+        std::cerr << "Rank " << rank << " has no cell to simulate" << std::endl;
+        return false;
+    }
+
+    TemperatureGrid block;
+    haloExchange.extractBlock(matrix, block);
+    HeatMapEngine engine;
+    engine.setThreadCount(1);
+    engine.setEpsilon(epsilon);
+    engine.loadMatrix(block);
+    engine.setHaloExchange(&haloExchange);
+    const bool reached = engine.run();
+
+    // The slowest process sets the pace, so the largest times of all of them are reported.
+    result.seconds = engine.getSolveSeconds();
+    result.communicationSeconds = haloExchange.getCommunicationSeconds();
+    result.computeSeconds = result.seconds - result.communicationSeconds;
+    result.generationCount = engine.getGenerationCount();
+    return reached && transport.allReduceMaximum(result.seconds) && transport.allReduceMaximum(result.computeSeconds)
+            && transport.allReduceMaximum(result.communicationSeconds) && haloExchange.gather(engine.getResult(), matrix);
+}
+
+TemperatureGrid HeatMapTester::makePlate(size_t side, double rightTemperature)
+{
+    TemperatureGrid matrix(side + 2, side + 2, 0.0);
+    for ( size_t column = 0; column < side + 2; ++column )
+        matrix(0, column) = 100.0;
+    for ( size_t row = 1; row < side + 2; ++row )
+        matrix(row, side + 1) = rightTemperature;
+    return matrix;
+}
+
+double HeatMapTester::timePool(TemperatureGrid& previous, TemperatureGrid& current, int workerCount, TileScheduler::Decomposition decomposition, size_t generations)
+{
+    TileScheduler scheduler;
+    scheduler.setup(previous.getInteriorRows(), previous.getInteriorColumns(), workerCount, 0, decomposition, true);
+    GenerationBarrier barrier;
+    size_t generation = 0;
+    barrier.reset( workerCount, [&scheduler, &generation, generations]() { scheduler.reset(); return ++generation < generations; } );
+
+    std::vector<HeatMapWorker*> workers;
+    for ( int workerId = 0; workerId < workerCount; ++workerId )
+    {
+        workers.push_back( new HeatMapWorker(workerId, workerCount, 0.0, &previous, &current) );
+        workers.back()->setGenerationBarrier(&barrier);
+        workers.back()->setTileScheduler(&scheduler);
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for ( HeatMapWorker* worker : workers )
+        worker->start();
+    for ( HeatMapWorker* worker : workers )
+    {
+        worker->wait();
+        delete worker;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+double HeatMapTester::timeSweeps(TemperatureGrid& previous, TemperatureGrid& current, int workerCount, size_t tileHeight, size_t tileWidth, size_t generations)
+{
+    const size_t interiorRows = previous.getInteriorRows();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for ( size_t generation = 0; generation < generations; ++generation )
+    {
+        // Every worker sweeps the same stripe of rows that HeatMapWorker would assign to it.
+        std::vector<std::thread> workers;
+        for ( int workerId = 0; workerId < workerCount; ++workerId )
+        {
+            workers.emplace_back( [&previous, &current, interiorRows, workerCount, workerId, tileHeight, tileWidth]()
+            {
+                const size_t startRow = HeatMapWorker::calculateStart(interiorRows, workerCount, workerId);
+                const size_t finishRow = HeatMapWorker::calculateFinish(interiorRows, workerCount, workerId);
+                StencilKernel::sweepTiles( StencilKernel::getSelectedVariant(), previous.interior(startRow), current.interior(startRow), previous.getStride()
+                                         , finishRow - startRow, previous.getInteriorColumns(), tileHeight, tileWidth );
+            } );
+        }
+        for ( std::thread& worker : workers )
+            worker.join();
+        previous.swap(current);
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
 
 int HeatMapTester::testDirectory(const QString &testDirectoryPath)
 {
@@ -52,15 +908,12 @@ int HeatMapTester::testDirectory(const QString &testDirectoryPath)
 
     this->testFiles = dir.entryInfoList();
 
-    this->connect( this->heatMapModel, &HeatMapModel::simulationDone, this, &HeatMapTester::verifyOutput );
-
     for(int inputFileIndex = 0; inputFileIndex < testFiles.size(); ++inputFileIndex)
     {
         if(testFiles[inputFileIndex].baseName().startsWith("input"))
         {
-            if(!outputMatrix.empty())
-                this->outputMatrix.clear();
-            this->heatMapModel->restartMatrix();
+            if(!this->outputMatrix->empty())
+                this->outputMatrix->clear();
 
             QStringList testCaseInfo = getTestCaseInfo(testFiles[inputFileIndex]);
 
@@ -75,19 +928,28 @@ int HeatMapTester::testDirectory(const QString &testDirectoryPath)
 
 int HeatMapTester::runTestCase(const double &epsilon, const QString &inputCsvFilePath)
 {
-    this->heatMapModel->setEpsilon(epsilon);
-    this->heatMapModel->fillTemperatureMatrix(inputCsvFilePath);
-    this->heatMapModel->setMaxAndMinTemperature();
+    this->engine->setEpsilon(epsilon);
+    if( !this->engine->loadFile( inputCsvFilePath.toStdString() ) )
+    {
+        std::cerr << "error: HeatMapTester: Could not open file " << qPrintable(inputCsvFilePath) << std::endl;
+        return EXIT_FAILURE;
+    }
+    if( this->engine->getRaggedRowCount() > 0 )
+        std::cerr << "warning: HeatMapTester: " << this->engine->getRaggedRowCount() << " ragged rows in " << qPrintable(inputCsvFilePath) << std::endl;
 
-    this->heatMapModel->run();
+    // The tuned configuration only applies to this case, the next one starts again from the command line settings.
+    const AutoTuner::Configuration baseline = AutoTuner::capture(*this->engine);
+    AutoTuner::Configuration configuration;
+    if( this->tuningProfile && this->autoTuner->findConfiguration( this->engine->getNumberOfRows(), this->engine->getNumberOfColumns(), configuration ) )
+        AutoTuner::apply(configuration, *this->engine);
+    if( this->engine->run() )
+        this->verifyOutput();
+    AutoTuner::apply(baseline, *this->engine);
     return EXIT_SUCCESS;
 }
 
 void HeatMapTester::verifyOutput()
 {
-    this->heatMapModel->exit();
-    this->heatMapModel->deleteLater();
-
     for(int index = 0; index < this->testFiles.size(); ++index)
     {
         if( testFiles[index].fileName() == this->outputFileName )
@@ -96,6 +958,36 @@ void HeatMapTester::verifyOutput()
             std::cout << "Testing: " << qPrintable( this->inputFileName )<< " with " << qPrintable( this->outputFileName ) <<"..." << std::endl;
             this->loadOutput(this->testFiles[index].filePath());
             this->compareContents(this->testFiles[index].filePath());
+            std::cout << "Solver: " << getSolverName( this->engine->getSolver() ) << ", generations: " << this->engine->getGenerationCount();
+            if ( this->engine->getSolver() == SOR_SOLVER )
+                std::cout << ", omega: " << this->engine->getRelaxationFactor();
+            if ( this->engine->getSolver() == CONJUGATE_GRADIENT_SOLVER )
+                std::cout << ", residual norm: " << this->engine->getResidualNorm();
+            std::cout << ", time to solution: " << this->engine->getSolveSeconds() << " s, loaded at " << this->engine->getLoadThroughput() << " MB/s";
+            // The multigrid and direct solvers run in the calling thread, without the worker pool.
+            const bool pooled = this->engine->getSolver() != MULTIGRID_SOLVER && this->engine->getSolver() != DIRECT_SOLVER;
+            if ( pooled )
+                std::cout << ", handoff latency: " << this->engine->getHandoffLatency() * 1e6 << " us, phase completion: "
+                          << this->engine->getPhaseCompletionTime() * 1e6 << " us";
+            std::cout << std::endl;
+            if ( pooled )
+            {
+                const std::vector<long long> stolenTileCounts = this->engine->getStolenTileCounts();
+                const std::vector<double> idleSeconds = this->engine->getIdleSeconds();
+                const std::vector<int> workerCpus = this->engine->getWorkerCpus();
+                const std::vector< std::vector<size_t> > partitionPages = this->engine->getPartitionPages();
+                for ( size_t workerId = 0; workerId < stolenTileCounts.size(); ++workerId )
+                {
+                    std::cout << "  worker " << workerId << ": stolen tiles: " << stolenTileCounts[workerId] << ", idle: " << idleSeconds[workerId] << " s";
+                    if ( workerId < workerCpus.size() && workerId < partitionPages.size() )
+                    {
+                        std::cout << ", cpu " << workerCpus[workerId] << " on node " << NumaTopology::getNodeOfCpu(workerCpus[workerId]) << ", pages per node:";
+                        for ( size_t pages : partitionPages[workerId] )
+                            std::cout << " " << pages;
+                    }
+                    std::cout << "\n";
+                }
+            }
             std::cout << "-------------------------------------------------\n";
         }
     }
@@ -104,11 +996,13 @@ void HeatMapTester::verifyOutput()
 void HeatMapTester::compareContents(const QString &outputCsvFilename)
 {
     double outputRangeDifference = this->detectPrecisionDifference(outputCsvFilename);
-    for(size_t row = 1; row < this->outputMatrix.size()-1; ++row)
+    // The engine is not running anymore, so its result is read in place.
+    const TemperatureGrid& result = this->engine->getResult();
+    for(size_t row = 1; row + 1 < this->outputMatrix->getNumberOfRows(); ++row)
     {
-        for(size_t column = 1; column < this->outputMatrix[0].size()-1; ++column)
+        for(size_t column = 1; column + 1 < this->outputMatrix->getNumberOfColumns(); ++column)
         {
-            if( ! FLOAT_EQUALS(this->heatMapModel->getValue(row,column), this->outputMatrix[row][column]) )
+            if( ! FLOAT_EQUALS(result(row,column), (*this->outputMatrix)(row,column)) )
             {
                std::cerr << "error: HeatMapTester: Test case failed " << " at [" << row <<"]["<< column << "]"<<std::endl;
                return;
@@ -124,30 +1018,11 @@ QStringList HeatMapTester::getTestCaseInfo(const QFileInfo &fileInfo)
 
 int HeatMapTester::loadOutput(const QString &outputCsvFilename)
 {
-    if( !outputCsvFilename.isEmpty() )
-    {
-        QFile file(outputCsvFilename);
-
-        if( file.open(QFile::ReadOnly | QFile::Text) )
-        {
-            QTextStream fileContent(&file);
-            QStringList rowElements = {};
-            QString row = "";
-            while( !fileContent.atEnd() )
-            {
-                row = fileContent.readLine();
-                rowElements = row.split(',');
-
-                std::vector<double> newRow = {};
-                for(int currentElement  = 0; currentElement < rowElements.length(); ++currentElement)
-                {
-                    newRow.push_back(rowElements.at(currentElement).toDouble());
-                }
-                this->outputMatrix.push_back( newRow );
-            }
-        }
-        file.close();
-    }
+    // The expected results are read by the same parser as the inputs.
+    if( !this->fileHandler->processFile(outputCsvFilename.toStdString(), *this->outputMatrix) )
+        return EXIT_FAILURE;
+    if( this->fileHandler->getLastRaggedRowCount() > 0 )
+        std::cerr << "warning: HeatMapTester: " << this->fileHandler->getLastRaggedRowCount() << " ragged rows in " << qPrintable(outputCsvFilename) << std::endl;
     return EXIT_SUCCESS;
 }
 
@@ -4,7 +4,17 @@
 #include <QCoreApplication>
 #include <QFileInfo>
 
-class HeatMapModel;
+#include "TileScheduler.h"
+
+// Option that makes the tester run one rank of the distributed benchmark, used to start its copies.
+#define DISTRIBUTED_RANK_OPTION "--distributed-rank"
+// Seconds a rank of the distributed benchmark waits for the others to start.
+#define DISTRIBUTED_CONNECT_SECONDS 30.0
+
+class AutoTuner;
+class FileHandler;
+class HeatMapEngine;
+class TemperatureGrid;
 class QFileInfo;
 
 
@@ -15,13 +25,28 @@ class HeatMapTester : public QCoreApplication
     Q_DISABLE_COPY(HeatMapTester)
 
 private:
+    /**
+     * @brief Times of a distributed simulation, the largest of any process.
+     */
+    struct DistributedResult
+    {
+        double seconds = 0.0;
+        double computeSeconds = 0.0;
+        double communicationSeconds = 0.0;
+        size_t generationCount = 0;
+    };
+
     QString inputFileName;
     QString outputFileName;
     QFileInfoList testFiles;
 
 protected:
-    std::vector< std::vector <double> > outputMatrix;
-    HeatMapModel * heatMapModel = nullptr;
+    TemperatureGrid * outputMatrix = nullptr;
+    FileHandler * fileHandler = nullptr;
+    HeatMapEngine * engine = nullptr;
+    AutoTuner * autoTuner = nullptr;
+    // Whether the tuned configuration of the profile is applied to every test case.
+    bool tuningProfile = true;
 
 
 public:
@@ -50,6 +75,148 @@ private:
      */
     static int printHelp();
 
+    /**
+     * @brief Print the throughput of every stencil kernel variant supported by this processor.
+     * The matrix size can be given after the --benchmark-kernels option.
+     * @return Exit success code.
+     */
+    int benchmarkKernels();
+
+    /**
+     * @brief Compare the throughput of the tiled sweep against the default row by row sweep, with as many workers
+     * as the simulation would use, and print the estimated bytes moved per cell of each traversal.
+     * The matrix size and the tile shape can be given after the --benchmark-tiles option.
+     * @return Exit success code.
+     */
+    int benchmarkTiles();
+
+    /**
+     * @brief Compare the time to hand a generation over between the workers through the generation barrier of the
+     * pool, against the queued signal to every worker and back that the model used before. The workers do no work,
+     * so the time per generation is the handoff latency alone.
+     * The number of workers and generations can be given after the --benchmark-handoff option.
+     * @return Exit success code.
+     */
+    int benchmarkHandoff();
+
+    /**
+     * @brief Print the Jacobi throughput of the worker pool from one to the given number of threads, splitting
+     * square, wide and tall matrices of the same size in row stripes and in blocks, together with the cells each
+     * decomposition reads from the blocks of other workers.
+     * The number of interior cells and the maximum number of threads can be given after the --benchmark-scaling option.
+     * @return Exit success code.
+     */
+    int benchmarkScaling();
+
+    /**
+     * @brief Compare the wall-clock time to reach the equilibrium state of the synchronous red-black solver against
+     * the asynchronous relaxation, from one thread to the given number of them doubling it every time, together
+     * with the largest error of each result against the direct solver.
+     * The number of interior cells, the maximum number of threads and the epsilon can be given after the
+     * --benchmark-async option.
+     * @return Exit success code.
+     */
+    int benchmarkAsynchronous();
+
+    /**
+     * @brief Compare a Jacobi simulation in one process against the same one split among several local processes,
+     * from two processes to the given number of them doubling it every time, in row stripes and in blocks. Each
+     * process simulates its block with one worker and exchanges its halo through Unix sockets every generation. It
+     * prints the time spent computing and communicating, which includes waiting for the slowest neighbour, and the
+     * largest difference of the gathered result against the single process one.
+     * The number of interior cells, the maximum number of processes and the epsilon can be given after the
+     * --benchmark-distributed option.
+     * @return Exit success code.
+     */
+    int benchmarkDistributed();
+
+    /**
+     * @brief Stop every iterative solver several times while it runs and resume it, and print how long it took to
+     * stop, together with the generations and the largest difference of the result against an uninterrupted run.
+     * Every solver is also stopped between two runs, which must not stop the second one.
+     * The number of interior cells and the number of stops can be given after the --benchmark-stop option.
+     * @return Exit success code.
+     */
+    int benchmarkStop();
+
+    /**
+     * @brief Load the given file with one thread, and then with twice as many up to every hardware thread, and print
+     * the throughput of each load. The file is given after the --benchmark-load option.
+     * @return Exit success code.
+     */
+    int benchmarkLoad();
+
+    /**
+     * @brief Convert the matrix of a .csv or binary grid file to the format given by the extension of the output
+     * file. The checksum of a binary input is verified. The type of the cells of a binary file can be given after
+     * both files.
+     * @return Exit success code, or exit failure code if a file could not be read or written.
+     */
+    int convert();
+
+    /**
+     * @brief Simulate a binary grid file with Jacobi one band of rows at a time, keeping only a few bands in memory,
+     * and write the equilibrium state to the output file. Print the size of the window of bands and the throughput.
+     * The input file, the output file, the epsilon and optionally the rows of a band are given after the
+     * --out-of-core option.
+     * @return Exit success code if the equilibrium state was reached and written.
+     */
+    int runOutOfCore();
+
+    /**
+     * @brief Simulate a file until the equilibrium state, writing a checkpoint every few seconds, and write the
+     * result to the checkpoint as well. If the checkpoint already exists, the simulation continues from it instead,
+     * so a run that was killed resumes where its last checkpoint was written. The input file, the checkpoint, the
+     * epsilon and optionally the seconds between two checkpoints are given after the --checkpoint option.
+     * @return Exit success code if the equilibrium state was reached and written.
+     */
+    int runCheckpointed();
+
+    /**
+     * @brief Time the candidate thread counts, tile shapes and kernel variants on a matrix of the given size, print
+     * them, and store the fastest configuration in the profile that later runs load.
+     * The number of rows and columns of the matrix are given after the --autotune option.
+     * @return Exit success code if the profile was saved.
+     */
+    int autotune();
+
+    /**
+     * @brief Run one of the processes started by benchmarkDistributed(), whose rank and simulation are given after
+     * the DISTRIBUTED_RANK_OPTION option.
+     * @return Exit success code if the simulation reached the equilibrium state.
+     */
+    int runDistributedRank();
+
+    /**
+     * @brief Simulate the block of the given rank of the matrix until the whole matrix reaches the equilibrium state.
+     * @param matrix The whole matrix, which the first rank receives the result in.
+     * @param result Receives the times and generations of the simulation.
+     * @return true if the equilibrium state was reached and the result gathered.
+     */
+    bool simulateDistributed(int rank, int processes, double epsilon, TileScheduler::Decomposition decomposition, const QString& socketPrefix, TemperatureGrid& matrix, DistributedResult& result);
+
+    /**
+     * @brief Build the square plate the benchmarks simulate: heated to 100 degrees on its top edge, held at the given
+     * temperature on its right edge and at zero on the others.
+     * @param side Number of interior rows and columns.
+     */
+    static TemperatureGrid makePlate(size_t side, double rightTemperature = 0.0);
+
+    /**
+     * @brief Measure the time spent running the given number of generations split in worker stripes.
+     * @param tileHeight Number of rows of each tile, zero to sweep one row at a time.
+     * @param tileWidth Number of columns of each tile, zero to sweep whole rows.
+     * @return Elapsed seconds.
+     */
+    double timeSweeps(TemperatureGrid& previous, TemperatureGrid& current, int workerCount, size_t tileHeight, size_t tileWidth, size_t generations);
+
+    /**
+     * @brief Measure the time the worker pool spends running the given number of Jacobi generations.
+     * @param decomposition How the interior is split among the workers.
+     * @return Elapsed seconds.
+     */
+    double timePool(TemperatureGrid& previous, TemperatureGrid& current, int workerCount, TileScheduler::Decomposition decomposition, size_t generations);
+
     /**
      * @brief Locate each input file on the current directory, run the heat simulation, and compare the
      * results obtained with its corresponding output file.
@@ -96,9 +263,8 @@ private:
      */
     double detectPrecisionDifference(const QString& outputCsvFilename);
 
-private slots:
     /**
-      * @brief Recieves a signal from HeatMapModel when the simulation has ended.
+      * @brief Compares the result of the engine with the output file, once the simulation reached the equilibrium state.
     */
     void verifyOutput();
 
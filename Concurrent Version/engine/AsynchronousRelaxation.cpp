@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "AsynchronousRelaxation.h"
+#include "CancellationToken.h"
+#include "StencilKernel.h"
+
+// Edges are padded to whole cache lines, so publishing one does not invalidate the edge of another worker.
+#define EDGE_CELL_MULTIPLE 8
+
+static size_t padEdge(size_t cellCount)
+{
+    return (cellCount + EDGE_CELL_MULTIPLE - 1) / EDGE_CELL_MULTIPLE * EDGE_CELL_MULTIPLE;
+}
+
+AsynchronousRelaxation::AsynchronousRelaxation()
+    : settledCount(0)
+    , round(0)
+    , reportCount(0)
+    , objectionCount(0)
+    , finished(false)
+{
+}
+
+void AsynchronousRelaxation::setup(TemperatureGrid * matrix, const TileScheduler& scheduler, double epsilon, size_t sweepLimit)
+{
+    this->matrix = matrix;
+    this->epsilon = epsilon;
+    this->sweepLimit = sweepLimit;
+    this->settledCount = 0;
+    this->round = 0;
+    this->reportCount = 0;
+    this->objectionCount = 0;
+    this->finished = false;
+
+    // The tiles of a worker are bands of the same block, so its block goes from the first one to the last one.
+    const int gridColumns = scheduler.getGridColumns();
+    const int workerCount = scheduler.getGridRows() * gridColumns;
+    this->partitions.clear();
+    this->partitions.resize(workerCount);
+    size_t edgeCellCount = 0;
+    for( int workerId = 0; workerId < workerCount; ++workerId )
+    {
+        Partition& partition = this->partitions[workerId];
+        size_t firstTile = 0;
+        size_t finishTile = 0;
+        scheduler.getOwnTiles(workerId, firstTile, finishTile);
+        if( firstTile < finishTile )
+        {
+            partition.block = scheduler.getTile(firstTile);
+            partition.block.finishRow = scheduler.getTile(finishTile - 1).finishRow;
+        }
+        else
+            partition.block = TileScheduler::Tile{0, 0, 0, 0};
+
+        const int blockRow = workerId / gridColumns;
+        const int blockColumn = workerId % gridColumns;
+        partition.above = blockRow > 0 ? workerId - gridColumns : -1;
+        partition.below = workerId + gridColumns < workerCount ? workerId + gridColumns : -1;
+        partition.left = blockColumn > 0 ? workerId - 1 : -1;
+        partition.right = blockColumn + 1 < gridColumns ? workerId + 1 : -1;
+
+        const size_t rowCount = partition.block.finishRow - partition.block.startRow;
+        const size_t columnCount = partition.block.finishColumn - partition.block.startColumn;
+        partition.topEdge = edgeCellCount;
+        partition.bottomEdge = partition.topEdge + padEdge(columnCount);
+        partition.leftEdge = partition.bottomEdge + padEdge(columnCount);
+        partition.rightEdge = partition.leftEdge + padEdge(rowCount);
+        edgeCellCount = partition.rightEdge + padEdge(rowCount);
+    }
+
+    // The atomics cannot be copied, so the edges are built in place. A neighbour may read an edge before its
+    // worker sweeps once, so they start with the cells of the matrix.
+    std::vector< std::atomic<double> > edgeCells(edgeCellCount);
+    this->edgeCells.swap(edgeCells);
+    for( Partition& partition : this->partitions )
+    {
+        const TileScheduler::Tile& block = partition.block;
+        if( block.startRow == block.finishRow || block.startColumn == block.finishColumn )
+            continue;
+        for( size_t column = block.startColumn; column < block.finishColumn; ++column )
+        {
+            this->edgeCells[partition.topEdge + column - block.startColumn].store( this->matrix->interior(block.startRow)[column], std::memory_order_relaxed );
+            this->edgeCells[partition.bottomEdge + column - block.startColumn].store( this->matrix->interior(block.finishRow - 1)[column], std::memory_order_relaxed );
+        }
+        for( size_t row = block.startRow; row < block.finishRow; ++row )
+        {
+            this->edgeCells[partition.leftEdge + row - block.startRow].store( this->matrix->interior(row)[block.startColumn], std::memory_order_relaxed );
+            this->edgeCells[partition.rightEdge + row - block.startRow].store( this->matrix->interior(row)[block.finishColumn - 1], std::memory_order_relaxed );
+        }
+    }
+}
+
+void AsynchronousRelaxation::relax(int workerId, const CancellationToken * cancellationToken)
+{
+    Partition& partition = this->partitions[workerId];
+    const TileScheduler::Tile& block = partition.block;
+    const size_t rowCount = block.finishRow - block.startRow;
+    const size_t columnCount = block.finishColumn - block.startColumn;
+    const bool empty = rowCount == 0 || columnCount == 0;
+
+    // The worker writes its private grid first, so its pages are placed on its own node. Its border is the halo
+    // around the block: the border of the matrix where the block touches it, and the edges of the neighbours,
+    // which are read from what they publish since a neighbour that stops first writes its block back meanwhile.
+    partition.sweepCount = 0;
+    partition.settled = false;
+    partition.confirmedRound = 0;
+    if( !empty )
+    {
+        partition.cells.resize(rowCount + 2, columnCount + 2);
+        const size_t firstRow = partition.above < 0 ? 0 : 1;
+        const size_t finishRow = partition.below < 0 ? rowCount + 2 : rowCount + 1;
+        for( size_t row = firstRow; row < finishRow; ++row )
+        {
+            const double* source = this->matrix->row(block.startRow + row) + block.startColumn;
+            double* target = partition.cells.row(row);
+            if( row == 0 || row == rowCount + 1 || (partition.left < 0 && partition.right < 0) )
+            {
+                std::memcpy( target, source, (columnCount + 2) * sizeof(double) );
+                continue;
+            }
+            std::memcpy( target + 1, source + 1, columnCount * sizeof(double) );
+            if( partition.left < 0 )
+                target[0] = source[0];
+            if( partition.right < 0 )
+                target[columnCount + 1] = source[columnCount + 1];
+        }
+    }
+
+    const size_t stride = partition.cells.getStride();
+    // A worker that reaches the limit leaves any open round unconfirmed, so the next call starts a new one.
+    while( !this->finished.load(std::memory_order_acquire) && !(cancellationToken != nullptr && cancellationToken->isRequested())
+           && (this->sweepLimit == 0 || partition.sweepCount < this->sweepLimit) )
+    {
+        const size_t sweepRound = this->round.load(std::memory_order_acquire);
+        double maximumDelta = 0.0;
+        if( empty )
+            std::this_thread::yield();
+        else
+        {
+            this->readHalo(partition);
+            for( int color = 0; color < 2; ++color )
+                maximumDelta = std::max( maximumDelta, StencilKernel::sweepColor(partition.cells.interior(0), stride, block.startRow, block.startColumn, rowCount, columnCount, color) );
+            this->publishEdges(partition);
+        }
+        ++partition.sweepCount;
+        this->updateTermination(partition, sweepRound, maximumDelta <= this->epsilon);
+    }
+
+    // The blocks do not overlap, so every worker writes its own back without waiting for the others.
+    if( !empty )
+        for( size_t row = 0; row < rowCount; ++row )
+            std::memcpy( this->matrix->interior(block.startRow + row) + block.startColumn, partition.cells.interior(row), columnCount * sizeof(double) );
+    partition.cells.clear();
+}
+
+bool AsynchronousRelaxation::isFinished() const
+{
+    return this->finished.load();
+}
+
+size_t AsynchronousRelaxation::getAverageSweepCount() const
+{
+    size_t sweepCount = 0;
+    for( const Partition& partition : this->partitions )
+        sweepCount += partition.sweepCount;
+    return this->partitions.empty() ? 0 : sweepCount / this->partitions.size();
+}
+
+void AsynchronousRelaxation::readHalo(Partition& partition)
+{
+    // Any value a neighbour published is a valid halo, so the edges are read cell by cell without locking them.
+    const size_t rowCount = partition.block.finishRow - partition.block.startRow;
+    const size_t columnCount = partition.block.finishColumn - partition.block.startColumn;
+    if( partition.above >= 0 )
+    {
+        const size_t edge = this->partitions[partition.above].bottomEdge;
+        double* halo = partition.cells.row(0) + 1;
+        for( size_t column = 0; column < columnCount; ++column )
+            halo[column] = this->edgeCells[edge + column].load(std::memory_order_relaxed);
+    }
+    if( partition.below >= 0 )
+    {
+        const size_t edge = this->partitions[partition.below].topEdge;
+        double* halo = partition.cells.row(rowCount + 1) + 1;
+        for( size_t column = 0; column < columnCount; ++column )
+            halo[column] = this->edgeCells[edge + column].load(std::memory_order_relaxed);
+    }
+    if( partition.left >= 0 )
+    {
+        const size_t edge = this->partitions[partition.left].rightEdge;
+        for( size_t row = 0; row < rowCount; ++row )
+            partition.cells.interior(row)[-1] = this->edgeCells[edge + row].load(std::memory_order_relaxed);
+    }
+    if( partition.right >= 0 )
+    {
+        const size_t edge = this->partitions[partition.right].leftEdge;
+        for( size_t row = 0; row < rowCount; ++row )
+            partition.cells.interior(row)[columnCount] = this->edgeCells[edge + row].load(std::memory_order_relaxed);
+    }
+}
+
+void AsynchronousRelaxation::publishEdges(Partition& partition)
+{
+    // Edges along the border of the matrix have no reader.
+    const size_t rowCount = partition.block.finishRow - partition.block.startRow;
+    const size_t columnCount = partition.block.finishColumn - partition.block.startColumn;
+    if( partition.above >= 0 )
+        for( size_t column = 0; column < columnCount; ++column )
+            this->edgeCells[partition.topEdge + column].store( partition.cells.interior(0)[column], std::memory_order_relaxed );
+    if( partition.below >= 0 )
+        for( size_t column = 0; column < columnCount; ++column )
+            this->edgeCells[partition.bottomEdge + column].store( partition.cells.interior(rowCount - 1)[column], std::memory_order_relaxed );
+    if( partition.left >= 0 )
+        for( size_t row = 0; row < rowCount; ++row )
+            this->edgeCells[partition.leftEdge + row].store( partition.cells.interior(row)[0], std::memory_order_relaxed );
+    if( partition.right >= 0 )
+        for( size_t row = 0; row < rowCount; ++row )
+            this->edgeCells[partition.rightEdge + row].store( partition.cells.interior(row)[columnCount - 1], std::memory_order_relaxed );
+}
+
+void AsynchronousRelaxation::updateTermination(Partition& partition, size_t sweepRound, bool settled)
+{
+    const int workerCount = static_cast<int>(this->partitions.size());
+    if( settled != partition.settled )
+    {
+        partition.settled = settled;
+        this->settledCount.fetch_add(settled ? 1 : -1);
+    }
+
+    // A sweep that started while a round was open reports on it, once per round. The round cannot be closed
+    // before every worker reported, so it is still the one read when the sweep started.
+    if( (sweepRound & 1) != 0 )
+    {
+        if( partition.confirmedRound == sweepRound )
+            return;
+        partition.confirmedRound = sweepRound;
+        if( !settled )
+            this->objectionCount.fetch_add(1);
+        if( this->reportCount.fetch_add(1) + 1 < workerCount )
+            return;
+        if( this->objectionCount.load() == 0 )
+            this->finished.store(true, std::memory_order_release);
+        else
+        {
+            this->reportCount = 0;
+            this->objectionCount = 0;
+            this->round.store(sweepRound + 1, std::memory_order_release);
+        }
+        return;
+    }
+
+    if( this->settledCount.load() == workerCount )
+        this->round.compare_exchange_strong(sweepRound, sweepRound + 1);
+}
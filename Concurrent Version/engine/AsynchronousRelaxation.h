@@ -0,0 +1,111 @@
+#ifndef ASYNCHRONOUSRELAXATION_H
+#define ASYNCHRONOUSRELAXATION_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "TemperatureGrid.h"
+#include "TileScheduler.h"
+
+class CancellationToken;
+
+/**
+ * Chaotic relaxation: every worker sweeps its own block over and over with red-black Gauss-Seidel, without waiting
+ * for the others between generations. Each block is copied into a private grid whose border is its halo, so no
+ * cell is ever written by one worker while another reads it. After every sweep a worker publishes the cells along
+ * the edges of its block, and before the next one it reads the latest edges published by its neighbours, whatever
+ * sweep they are in.
+ *
+ * There is no generation where every block is known at once, so the equilibrium state is detected with a
+ * termination protocol. A worker is settled while its last sweep changed no cell by more than epsilon. When a
+ * worker sees every worker settled it opens a confirmation round, in which each worker reports whether its next
+ * whole sweep, started after the round opened, still changed no cell by more than epsilon. The round ends the
+ * relaxation if every report agrees, and is closed to wait for the next one otherwise.
+ */
+class AsynchronousRelaxation
+{
+private:
+    struct alignas(64) Partition
+    {
+        TileScheduler::Tile block;
+        // Workers of the neighbouring blocks, or -1 where the block touches the border of the matrix.
+        int above = -1;
+        int below = -1;
+        int left = -1;
+        int right = -1;
+        // Where the edges of the block are published, as offsets in the edge cells.
+        size_t topEdge = 0;
+        size_t bottomEdge = 0;
+        size_t leftEdge = 0;
+        size_t rightEdge = 0;
+        // Only touched by the worker of the block while it relaxes.
+        TemperatureGrid cells;
+        size_t sweepCount = 0;
+        bool settled = false;
+        size_t confirmedRound = 0;
+    };
+
+    TemperatureGrid * matrix = nullptr;
+    double epsilon = 0.0;
+    size_t sweepLimit = 0;
+    std::vector<Partition> partitions;
+    std::vector< std::atomic<double> > edgeCells;
+
+    std::atomic<int> settledCount;
+    // Odd while a confirmation round is open.
+    std::atomic<size_t> round;
+    std::atomic<int> reportCount;
+    std::atomic<int> objectionCount;
+    std::atomic<bool> finished;
+
+public:
+    AsynchronousRelaxation();
+
+    /**
+     * @brief Splits the interior of the matrix in the blocks the scheduler gives to each worker, and publishes their
+     * initial edges. It must not be called while workers relax.
+     * @param matrix Matrix whose border is held fixed. Its interior is the initial guess and receives the result.
+     * @param scheduler Scheduler already set up for the workers, whose own tiles form the block of each worker.
+     * @param epsilon Maximum change of a cell in a sweep once the equilibrium state is reached.
+     * @param sweepLimit Maximum number of sweeps of every worker, or zero for no limit.
+     */
+    void setup(TemperatureGrid * matrix, const TileScheduler& scheduler, double epsilon, size_t sweepLimit);
+
+    /**
+     * @brief Relaxes the block of the given worker until the equilibrium state is detected, a stop is requested
+     * through the token or the worker reached the sweep limit, and copies the block back into the matrix. Every worker
+     * calls it from its own thread.
+     */
+    void relax(int workerId, const CancellationToken * cancellationToken);
+
+    /**
+     * @brief Returns true if the last relaxation ended because the equilibrium state was reached.
+     */
+    bool isFinished() const;
+
+    /**
+     * @brief Returns the average number of sweeps the workers ran in the last relaxation.
+     */
+    size_t getAverageSweepCount() const;
+
+private:
+    /**
+     * @brief Copies the latest edges of the neighbours into the halo of the given block.
+     */
+    void readHalo(Partition& partition);
+
+    /**
+     * @brief Publishes the cells along the edges of the given block.
+     */
+    void publishEdges(Partition& partition);
+
+    /**
+     * @brief Runs one step of the termination protocol after a sweep of the given block.
+     * @param sweepRound Round read before the sweep started.
+     * @param settled Whether the sweep changed no cell by more than epsilon.
+     */
+    void updateTermination(Partition& partition, size_t sweepRound, bool settled);
+};
+
+#endif // ASYNCHRONOUSRELAXATION_H
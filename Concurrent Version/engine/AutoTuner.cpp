@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <thread>
+
+#include "AutoTuner.h"
+#include "HeatMapEngine.h"
+#include "TemperatureGrid.h"
+
+// Tile shapes measured besides the default row by row traversal, as height and width.
+static const size_t tileShapes[][2] = { {16, 256}, {32, 512}, {64, 1024}, {128, 2048} };
+
+static size_t getInteriorCount(size_t cellCount)
+{
+    return cellCount > 2 ? cellCount - 2 : 0;
+}
+
+AutoTuner::AutoTuner()
+{
+}
+
+std::string AutoTuner::getDefaultProfilePath()
+{
+#ifdef _WIN32
+    const char* applicationData = std::getenv("APPDATA");
+    const std::string directory = applicationData != nullptr ? applicationData : ".";
+#else
+    const char* configuration = std::getenv("XDG_CONFIG_HOME");
+    const char* home = std::getenv("HOME");
+    const std::string directory = configuration != nullptr && *configuration != '\0' ? configuration
+            : home != nullptr ? std::string(home) + "/.config" : ".";
+#endif
+    return directory + "/HeatMapSimulator/tuning-profile.txt";
+}
+
+bool AutoTuner::loadProfile(const std::string& filePath)
+{
+    std::ifstream file(filePath);
+    if( !file.is_open() )
+        return false;
+
+    this->entries.clear();
+    std::string line;
+    while( std::getline(file, line) )
+    {
+        if( line.empty() || line[0] == '#' )
+            continue;
+        std::istringstream fields(line);
+        Entry entry;
+        std::string variantName;
+        if( !(fields >> entry.machine >> entry.rowClass >> entry.columnClass >> entry.configuration.threadCount >> entry.configuration.tileHeight
+              >> entry.configuration.tileWidth >> variantName >> entry.configuration.cellsPerSecond) )
+            continue;
+        int variant = StencilKernel::SCALAR;
+        while( variant < StencilKernel::VARIANT_COUNT && variantName != StencilKernel::getVariantName(static_cast<StencilKernel::Variant>(variant)) )
+            ++variant;
+        if( variant == StencilKernel::VARIANT_COUNT || entry.configuration.threadCount < 1 )
+            continue;
+        entry.configuration.variant = static_cast<StencilKernel::Variant>(variant);
+        this->entries.push_back(entry);
+    }
+    return true;
+}
+
+bool AutoTuner::saveProfile(const std::string& filePath) const
+{
+    std::error_code error;
+    const std::filesystem::path directory = std::filesystem::path(filePath).parent_path();
+    if( !directory.empty() )
+        std::filesystem::create_directories(directory, error);
+
+    std::ofstream file(filePath);
+    if( !file.is_open() )
+        return false;
+    file << "# machine row_class column_class threads tile_height tile_width variant cells_per_second\n";
+    for( const Entry& entry : this->entries )
+        file << entry.machine << ' ' << entry.rowClass << ' ' << entry.columnClass << ' ' << entry.configuration.threadCount << ' '
+             << entry.configuration.tileHeight << ' ' << entry.configuration.tileWidth << ' ' << StencilKernel::getVariantName(entry.configuration.variant)
+             << ' ' << entry.configuration.cellsPerSecond << '\n';
+    return static_cast<bool>(file);
+}
+
+bool AutoTuner::findConfiguration(size_t rowCount, size_t columnCount, Configuration& configuration) const
+{
+    const std::string machine = getMachineName();
+    const size_t rowClass = getSizeClass( getInteriorCount(rowCount) );
+    const size_t columnClass = getSizeClass( getInteriorCount(columnCount) );
+    for( const Entry& entry : this->entries )
+    {
+        if( entry.machine == machine && entry.rowClass == rowClass && entry.columnClass == columnClass )
+        {
+            configuration = entry.configuration;
+            return true;
+        }
+    }
+    return false;
+}
+
+AutoTuner::Configuration AutoTuner::tune(size_t rowCount, size_t columnCount, std::ostream* report)
+{
+    const size_t interiorRows = getInteriorCount(rowCount);
+    const size_t interiorColumns = getInteriorCount(columnCount);
+    const size_t interiorCells = std::max( interiorRows * interiorColumns, static_cast<size_t>(1) );
+
+    // A plate heated from its top edge, so every generation changes cells. A negative epsilon is never reached.
+    TemperatureGrid matrix(rowCount, columnCount, 0.0);
+    for( size_t column = 0; column < columnCount; ++column )
+        matrix(0, column) = 100.0;
+    HeatMapEngine engine;
+    engine.setEpsilon(-1.0);
+    engine.loadMatrix(matrix);
+
+    Configuration best;
+    std::vector<Configuration> candidates;
+    for( int variant = StencilKernel::SCALAR; variant < StencilKernel::VARIANT_COUNT; ++variant )
+    {
+        Configuration candidate;
+        candidate.variant = static_cast<StencilKernel::Variant>(variant);
+        if( StencilKernel::isSupported(candidate.variant) )
+            candidates.push_back(candidate);
+    }
+
+    // Every stage starts from the winner of the one before, so the candidates are built as it goes.
+    for( int stage = 0; stage < 3; ++stage )
+    {
+        if( stage == 1 )
+        {
+            const int hardwareThreads = std::max( static_cast<int>( std::thread::hardware_concurrency() ), 1 );
+            for( int threads = 2; threads <= hardwareThreads && static_cast<size_t>(threads) <= interiorRows;
+                 threads = threads < hardwareThreads && threads * 2 > hardwareThreads ? hardwareThreads : threads * 2 )
+            {
+                candidates.push_back(best);
+                candidates.back().threadCount = threads;
+            }
+        }
+        else if( stage == 2 )
+        {
+            // A tile as large as the interior sweeps it just like the default traversal.
+            for( const size_t* shape : tileShapes )
+            {
+                if( shape[0] >= interiorRows && shape[1] >= interiorColumns )
+                    break;
+                candidates.push_back(best);
+                candidates.back().tileHeight = shape[0];
+                candidates.back().tileWidth = shape[1];
+            }
+        }
+
+        for( Configuration& candidate : candidates )
+        {
+            measure(engine, interiorCells, candidate);
+            if( report != nullptr )
+                *report << "  " << StencilKernel::getVariantName(candidate.variant) << ", " << candidate.threadCount << " threads, tile "
+                        << candidate.tileHeight << "x" << candidate.tileWidth << ": " << candidate.cellsPerSecond << " cells/s" << std::endl;
+            if( candidate.cellsPerSecond > best.cellsPerSecond )
+                best = candidate;
+        }
+        candidates.clear();
+    }
+
+    Entry entry;
+    entry.machine = getMachineName();
+    entry.rowClass = getSizeClass(interiorRows);
+    entry.columnClass = getSizeClass(interiorColumns);
+    entry.configuration = best;
+    this->entries.erase( std::remove_if( this->entries.begin(), this->entries.end(), [&entry](const Entry& other)
+    {
+        return other.machine == entry.machine && other.rowClass == entry.rowClass && other.columnClass == entry.columnClass;
+    } ), this->entries.end() );
+    this->entries.push_back(entry);
+    return best;
+}
+
+void AutoTuner::apply(const Configuration& configuration, HeatMapEngine& engine)
+{
+    engine.setThreadCount(configuration.threadCount);
+    engine.setTileShape(configuration.tileHeight, configuration.tileWidth);
+    engine.setKernelVariant(configuration.variant);
+}
+
+AutoTuner::Configuration AutoTuner::capture(const HeatMapEngine& engine)
+{
+    Configuration configuration;
+    configuration.threadCount = engine.getThreadCount();
+    configuration.tileHeight = engine.getTileHeight();
+    configuration.tileWidth = engine.getTileWidth();
+    configuration.variant = engine.getKernelVariant();
+    return configuration;
+}
+
+std::string AutoTuner::getMachineName()
+{
+    // Machines with the same threads and instruction set usually share their best configuration, and a
+    // profile copied to a different kind of machine is simply ignored.
+    return std::to_string( std::thread::hardware_concurrency() ) + "-" + StencilKernel::getVariantName( StencilKernel::getBestSupportedVariant() );
+}
+
+size_t AutoTuner::getSizeClass(size_t cellCount)
+{
+    size_t sizeClass = 1;
+    while( sizeClass < cellCount )
+        sizeClass *= 2;
+    return sizeClass;
+}
+
+void AutoTuner::measure(HeatMapEngine& engine, size_t interiorCells, Configuration& configuration)
+{
+    const size_t generations = std::min( std::max( static_cast<size_t>(TUNING_CELL_UPDATES / interiorCells), static_cast<size_t>(TUNING_MINIMUM_GENERATIONS) )
+                                       , static_cast<size_t>(TUNING_MAXIMUM_GENERATIONS) );
+    apply(configuration, engine);
+
+    // The first generation brings the matrices into cache and is not counted.
+    engine.step(1);
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    engine.step(generations);
+    const double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    configuration.cellsPerSecond = seconds > 0.0 ? static_cast<double>(interiorCells) * generations / seconds : 0.0;
+}
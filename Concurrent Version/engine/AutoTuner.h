@@ -0,0 +1,117 @@
+#ifndef AUTOTUNER_H
+#define AUTOTUNER_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "StencilKernel.h"
+
+class HeatMapEngine;
+
+// Cell updates measured for every candidate, so each one takes a fraction of a second whatever the matrix size.
+#define TUNING_CELL_UPDATES 20000000.0
+// Fewest and most Jacobi generations measured for every candidate.
+#define TUNING_MINIMUM_GENERATIONS 3
+#define TUNING_MAXIMUM_GENERATIONS 1000
+
+/**
+ * Finds the fastest thread count, tile shape and kernel variant for the matrices of a given size on this machine,
+ * by timing a few Jacobi generations of each candidate. The winners are kept in a profile, one per kind of machine
+ * and size class, so they are measured once and loaded by every later run.
+ */
+class AutoTuner
+{
+public:
+    /**
+     * @brief Settings of the engine that ran the most cells per second for a size class.
+     */
+    struct Configuration
+    {
+        int threadCount = 1;
+        size_t tileHeight = 0;
+        size_t tileWidth = 0;
+        StencilKernel::Variant variant = StencilKernel::SCALAR;
+        double cellsPerSecond = 0.0;
+    };
+
+private:
+    struct Entry
+    {
+        std::string machine;
+        size_t rowClass = 0;
+        size_t columnClass = 0;
+        Configuration configuration;
+    };
+
+    std::vector<Entry> entries;
+
+public:
+    AutoTuner();
+
+    /**
+     * @brief Returns where the profile is kept for the current user, shared by every front end.
+     */
+    static std::string getDefaultProfilePath();
+
+    /**
+     * @brief Replaces the configurations with the ones of the profile. Lines that cannot be parsed are skipped.
+     * @return false if the file could not be opened.
+     */
+    bool loadProfile(const std::string& filePath);
+
+    /**
+     * @brief Writes every configuration to the profile, creating its directory if needed.
+     * @return false if the file could not be written.
+     */
+    bool saveProfile(const std::string& filePath) const;
+
+    /**
+     * @brief Looks for the configuration of this machine for matrices of the size class of the given one.
+     * @param rowCount Number of rows of the matrix, border included.
+     * @param columnCount Number of columns of the matrix, border included.
+     * @return false if that size was never tuned on this kind of machine.
+     */
+    bool findConfiguration(size_t rowCount, size_t columnCount, Configuration& configuration) const;
+
+    /**
+     * @brief Times the candidates on a matrix of the given size and keeps the fastest one for its size class.
+     * The kernel variant is chosen first with one worker, then the thread count with that variant, and then the
+     * tile shape with both, so only a few dozen candidates are measured.
+     * @param rowCount Number of rows of the matrix, border included.
+     * @param columnCount Number of columns of the matrix, border included.
+     * @param report Stream where every candidate is printed, or nullptr.
+     * @return The fastest configuration.
+     */
+    Configuration tune(size_t rowCount, size_t columnCount, std::ostream* report);
+
+    /**
+     * @brief Makes the engine use the given configuration, kernel variant included. Other engines are not affected.
+     */
+    static void apply(const Configuration& configuration, HeatMapEngine& engine);
+
+    /**
+     * @brief Returns the configuration the engine uses now, so it can be applied again once a tuned one is no
+     * longer wanted.
+     */
+    static Configuration capture(const HeatMapEngine& engine);
+
+private:
+    /**
+     * @brief Returns a name for the kind of this machine: its hardware threads and its best kernel variant.
+     */
+    static std::string getMachineName();
+
+    /**
+     * @brief Returns the size class of the given number of interior rows or columns, the next power of two.
+     */
+    static size_t getSizeClass(size_t cellCount);
+
+    /**
+     * @brief Runs a few Jacobi generations of the engine with the given configuration, and stores its throughput in it.
+     */
+    static void measure(HeatMapEngine& engine, size_t interiorCells, Configuration& configuration);
+};
+
+#endif // AUTOTUNER_H
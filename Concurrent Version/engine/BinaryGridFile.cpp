@@ -0,0 +1,195 @@
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "BinaryGridFile.h"
+#include "MappedFile.h"
+#include "TemperatureGrid.h"
+
+// Parameters of the 64 bit FNV-1a hash.
+#define CHECKSUM_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define CHECKSUM_PRIME 0x100000001b3ULL
+#define BYTE_ORDER_MARK 0x01020304u
+
+const char* BinaryGridFile::getDataTypeName(DataType dataType)
+{
+    static const char* const names[] = { "float64", "float32" };
+    return ( dataType >= FLOAT64 && dataType < DATA_TYPE_COUNT ) ? names[dataType] : "unknown";
+}
+
+bool BinaryGridFile::hasSignature(const char* data, size_t size)
+{
+    const size_t signatureSize = sizeof(BINARY_GRID_SIGNATURE) - 1;
+    return size >= signatureSize && std::memcmp(data, BINARY_GRID_SIGNATURE, signatureSize) == 0;
+}
+
+bool BinaryGridFile::inspect(const MappedFile& file, Layout& layout, bool verifyChecksum)
+{
+    const char* data = file.getData();
+    const size_t size = file.getSize();
+    Header header;
+    if( size < sizeof(header) || !hasSignature(data, size) )
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+    if( header.version != BINARY_GRID_VERSION || header.byteOrder != BYTE_ORDER_MARK || header.dataType >= DATA_TYPE_COUNT
+            || header.borderWidth != 1 || header.firstCellOffset < sizeof(header) || header.firstCellOffset > size )
+        return false;
+
+    // The cells must fit in the file, checked without multiplying values that could overflow.
+    const size_t cellSize = getCellSize( static_cast<DataType>(header.dataType) );
+    const uint64_t availableCells = (size - header.firstCellOffset) / cellSize;
+    if( header.rows > 0 && (header.columns > header.stride || header.columns > availableCells
+            || (header.stride > 0 && header.rows - 1 > (availableCells - header.columns) / header.stride)) )
+        return false;
+    layout.dataType = static_cast<DataType>(header.dataType);
+    layout.rows = static_cast<size_t>(header.rows);
+    layout.columns = layout.rows > 0 ? static_cast<size_t>(header.columns) : 0;
+    layout.stride = static_cast<size_t>(header.stride);
+    layout.firstCellOffset = static_cast<size_t>(header.firstCellOffset);
+    return !verifyChecksum || updateChecksum(CHECKSUM_OFFSET_BASIS, data + layout.firstCellOffset, getCellCount(layout) * cellSize) == header.checksum;
+}
+
+bool BinaryGridFile::read(const std::string& filePath, const MappedFile& file, TemperatureGrid& targetMatrix, bool verifyChecksum)
+{
+    Layout layout;
+    if( !inspect(file, layout, verifyChecksum) )
+        return false;
+    if( layout.dataType == FLOAT64 && targetMatrix.mapFile(filePath, layout.rows, layout.columns, layout.stride, layout.firstCellOffset) )
+        return true;
+
+    const size_t rowCount = layout.rows;
+    const size_t columnCount = layout.columns;
+    const size_t stride = layout.stride;
+    const DataType dataType = layout.dataType;
+    const size_t cellSize = getCellSize(dataType);
+    const char* cells = file.getData() + layout.firstCellOffset;
+
+    targetMatrix.reshape(rowCount, columnCount);
+    for( size_t row = 0; row < rowCount; ++row )
+    {
+        const char* source = cells + row * stride * cellSize;
+        double* target = targetMatrix.row(row);
+        if( dataType == FLOAT64 )
+            std::memcpy(target, source, columnCount * sizeof(double));
+        else
+        {
+            for( size_t column = 0; column < columnCount; ++column )
+            {
+                float value = 0.0f;
+                std::memcpy(&value, source + column * sizeof(float), sizeof(float));
+                target[column] = value;
+            }
+        }
+    }
+    return true;
+}
+
+bool BinaryGridFile::write(const std::string& filePath, const TemperatureGrid& sourceMatrix, DataType dataType)
+{
+    if( dataType < FLOAT64 || dataType >= DATA_TYPE_COUNT )
+        return false;
+    std::ofstream file(filePath, std::ios::binary);
+    if( !file.is_open() )
+        return false;
+
+    // Rows are padded as in a grid, and the first interior cell, one after the first cell, starts on an aligned
+    // offset, so a mapping of the whole file has the layout of a grid.
+    const size_t cellSize = getCellSize(dataType);
+    const size_t cellsPerBlock = GRID_ALIGNMENT / cellSize;
+    const size_t rowCount = sourceMatrix.getNumberOfRows();
+    const size_t columnCount = sourceMatrix.getNumberOfColumns();
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.signature, BINARY_GRID_SIGNATURE, sizeof(header.signature));
+    header.version = BINARY_GRID_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.dataType = static_cast<uint32_t>(dataType);
+    header.borderWidth = 1;
+    header.rows = rowCount;
+    header.columns = columnCount;
+    header.stride = (columnCount + cellsPerBlock - 1) / cellsPerBlock * cellsPerBlock;
+    header.firstCellOffset = sizeof(header) + GRID_ALIGNMENT - cellSize;
+
+    // The header is written again once the checksum is known.
+    file.write( reinterpret_cast<const char*>(&header), sizeof(header) );
+    const std::vector<char> gap(header.firstCellOffset - sizeof(header), 0);
+    file.write( gap.data(), static_cast<std::streamsize>( gap.size() ) );
+
+    const size_t rowBytes = static_cast<size_t>(header.stride) * cellSize;
+    std::vector<char> row(rowBytes, 0);
+    uint64_t checksum = CHECKSUM_OFFSET_BASIS;
+    for( size_t currentRow = 0; currentRow < rowCount; ++currentRow )
+    {
+        const double* source = sourceMatrix.row(currentRow);
+        if( dataType == FLOAT64 )
+            std::memcpy(row.data(), source, columnCount * sizeof(double));
+        else
+        {
+            for( size_t column = 0; column < columnCount; ++column )
+            {
+                const float value = static_cast<float>(source[column]);
+                std::memcpy(row.data() + column * sizeof(float), &value, sizeof(float));
+            }
+        }
+        // The last row ends at its last cell, as in a grid.
+        const size_t bytes = currentRow + 1 < rowCount ? rowBytes : columnCount * cellSize;
+        checksum = updateChecksum(checksum, row.data(), bytes);
+        file.write( row.data(), static_cast<std::streamsize>(bytes) );
+    }
+
+    header.checksum = checksum;
+    file.seekp(0);
+    file.write( reinterpret_cast<const char*>(&header), sizeof(header) );
+    return static_cast<bool>(file);
+}
+
+bool BinaryGridFile::seal(const std::string& filePath)
+{
+    Header header;
+    uint64_t checksum = CHECKSUM_OFFSET_BASIS;
+    {
+        MappedFile file;
+        if( !file.open(filePath) || file.getSize() < sizeof(header) || !hasSignature(file.getData(), file.getSize()) )
+            return false;
+        std::memcpy(&header, file.getData(), sizeof(header));
+        Layout layout;
+        layout.dataType = static_cast<DataType>(header.dataType);
+        layout.rows = static_cast<size_t>(header.rows);
+        layout.columns = static_cast<size_t>(header.columns);
+        layout.stride = static_cast<size_t>(header.stride);
+        const size_t bytes = getCellCount(layout) * getCellSize(layout.dataType);
+        if( header.dataType >= DATA_TYPE_COUNT || header.firstCellOffset > file.getSize() || bytes > file.getSize() - header.firstCellOffset )
+            return false;
+        checksum = updateChecksum(checksum, file.getData() + header.firstCellOffset, bytes);
+    }
+
+    header.checksum = checksum;
+    std::fstream file(filePath, std::ios::in | std::ios::out | std::ios::binary);
+    file.write( reinterpret_cast<const char*>(&header), sizeof(header) );
+    return static_cast<bool>(file);
+}
+
+size_t BinaryGridFile::getCellSize(DataType dataType)
+{
+    return dataType == FLOAT32 ? sizeof(float) : sizeof(double);
+}
+
+size_t BinaryGridFile::getCellCount(const Layout& layout)
+{
+    return layout.rows > 0 ? (layout.rows - 1) * layout.stride + layout.columns : 0;
+}
+
+uint64_t BinaryGridFile::updateChecksum(uint64_t checksum, const char* bytes, size_t size)
+{
+    // A word is hashed at a time instead of a byte, so the checksum does not slow the load down.
+    size_t offset = 0;
+    for( ; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t) )
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + offset, sizeof(word));
+        checksum = (checksum ^ word) * CHECKSUM_PRIME;
+    }
+    for( ; offset < size; ++offset )
+        checksum = (checksum ^ static_cast<unsigned char>(bytes[offset])) * CHECKSUM_PRIME;
+    return checksum;
+}
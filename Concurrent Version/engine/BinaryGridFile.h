@@ -0,0 +1,136 @@
+#ifndef BINARYGRIDFILE_H
+#define BINARYGRIDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Extension of the files written in the binary format, which can be opened wherever a .csv file can.
+#define BINARY_GRID_EXTENSION ".grid"
+// First bytes of every file in the binary format.
+#define BINARY_GRID_SIGNATURE "HEATGRID"
+#define BINARY_GRID_VERSION 1
+
+class MappedFile;
+class TemperatureGrid;
+
+/**
+ * Reads and writes matrices in a binary format that is loaded without parsing. A 64 byte header is followed by the
+ * cells, stored row after row with the same padding and alignment as a TemperatureGrid has in memory. A file of
+ * double precision cells is therefore mapped straight into the grid, copy on write, so loading it copies nothing:
+ * its pages are read from the page cache as they are touched, and the simulation never writes to the file. The
+ * checksum of the cells is only verified on request, since hashing them reads every page before the first
+ * generation.
+ */
+class BinaryGridFile
+{
+public:
+    /**
+     * @brief Type of the cells stored in the file.
+     */
+    enum DataType
+    {
+        FLOAT64,
+        FLOAT32,
+        DATA_TYPE_COUNT
+    };
+
+    /**
+     * @brief Where the cells of a file are and how they are laid out.
+     */
+    struct Layout
+    {
+        DataType dataType = FLOAT64;
+        size_t rows = 0;
+        size_t columns = 0;
+        size_t stride = 0;
+        size_t firstCellOffset = 0;
+    };
+
+private:
+    /**
+     * @brief Header at the start of every file, in the byte order of the machine that wrote it.
+     */
+    struct Header
+    {
+        char signature[8];
+        uint32_t version;
+        // Written as 0x01020304, so a file written with a different byte order is recognized and rejected.
+        uint32_t byteOrder;
+        uint32_t dataType;
+        // Rows and columns on each side that the simulation holds fixed.
+        uint32_t borderWidth;
+        uint64_t rows;
+        uint64_t columns;
+        // Cells between the start of two consecutive rows, padding included.
+        uint64_t stride;
+        // Offset in bytes of the first cell of the first row.
+        uint64_t firstCellOffset;
+        // FNV-1a hash of the cells, from the first one to the last one, padding included.
+        uint64_t checksum;
+    };
+
+    static_assert(sizeof(Header) == 64, "The header must fill one cache line");
+
+public:
+    /**
+     * @brief Returns a printable name for the given data type.
+     */
+    static const char* getDataTypeName(DataType dataType);
+
+    /**
+     * @brief Returns true if the given bytes start with the signature of the format.
+     */
+    static bool hasSignature(const char* data, size_t size);
+
+    /**
+     * @brief Checks the header of a file in the binary format, and optionally the checksum of its cells, and returns
+     * the layout of its cells.
+     * @param verifyChecksum Hash every cell and compare it with the checksum, which reads the whole file.
+     * @return false if the header is not valid, the file is truncated or its checksum does not match.
+     */
+    static bool inspect(const MappedFile& file, Layout& layout, bool verifyChecksum);
+
+    /**
+     * @brief Loads a file in the binary format into the given grid, after checking its header.
+     * Files of double precision cells are mapped into the grid where the system allows it, and copied otherwise.
+     * @param filePath Path of the file, mapped again by the grid.
+     * @param file The file, already mapped.
+     * @param targetMatrix Grid where the matrix is stored.
+     * @param verifyChecksum Check the checksum of the cells first, which reads the whole file.
+     * @return false if the header is not valid, the file is truncated or its checksum does not match.
+     */
+    static bool read(const std::string& filePath, const MappedFile& file, TemperatureGrid& targetMatrix, bool verifyChecksum);
+
+    /**
+     * @brief Writes the given grid to a file in the binary format.
+     * @param dataType Type of the stored cells. Single precision halves the file, but is copied when loaded.
+     * @return false if the file could not be written.
+     */
+    static bool write(const std::string& filePath, const TemperatureGrid& sourceMatrix, DataType dataType);
+
+    /**
+     * @brief Stores the checksum of the cells of a file whose cells were changed in place in its header, so it can
+     * be read again. The cells are read once, from the start to the end.
+     * @return false if the file is not in the binary format or could not be written.
+     */
+    static bool seal(const std::string& filePath);
+
+private:
+    /**
+     * @brief Returns the size in bytes of a cell of the given type.
+     */
+    static size_t getCellSize(DataType dataType);
+
+    /**
+     * @brief Returns the number of cells, padding included, between the first and the last cell of a file.
+     */
+    static size_t getCellCount(const Layout& layout);
+
+    /**
+     * @brief Adds the given bytes to a running FNV-1a hash. Every call but the last must hash a multiple of 8 bytes.
+     */
+    static uint64_t updateChecksum(uint64_t checksum, const char* bytes, size_t size);
+};
+
+#endif // BINARYGRIDFILE_H
@@ -0,0 +1,51 @@
+#include <chrono>
+
+#include "CancellationToken.h"
+
+static long long getSteadyNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+CancellationToken::CancellationToken()
+    : requested(false)
+    , requestNanoseconds(0)
+{
+}
+
+void CancellationToken::request()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if( !this->active || this->requested.load(std::memory_order_relaxed) )
+        return;
+    // The time is stored first, so a worker that sees the request also sees when it was made.
+    this->requestNanoseconds.store( getSteadyNanoseconds() );
+    this->requested.store(true, std::memory_order_release);
+}
+
+void CancellationToken::begin()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->requested = false;
+    this->requestNanoseconds = 0;
+    this->active = true;
+}
+
+void CancellationToken::end()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->active = false;
+}
+
+void CancellationToken::reset()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->requested = false;
+    this->requestNanoseconds = 0;
+}
+
+double CancellationToken::getSecondsSinceRequest() const
+{
+    const long long requestTime = this->requestNanoseconds.load();
+    return requestTime == 0 ? 0.0 : static_cast<double>( getSteadyNanoseconds() - requestTime ) * 1e-9;
+}
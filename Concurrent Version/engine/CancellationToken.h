@@ -0,0 +1,62 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <atomic>
+#include <mutex>
+
+/**
+ * Asks a running simulation to stop, from any thread. The workers poll it before every tile and between the bands
+ * of rows of a tile, and the solvers that run in the calling thread between their steps, so a stop takes effect
+ * within one band of work of every worker, however large the matrix is. Polling is a relaxed load, cheap enough to
+ * do far more often than a generation ends. A request only counts while a run is in flight, between begin() and
+ * end(), so one that comes after a run ended cannot stop the next one.
+ */
+class CancellationToken
+{
+private:
+    // Guards the run being in flight against a request that comes as it ends.
+    std::mutex mutex;
+    bool active = false;
+    std::atomic<bool> requested;
+    // Steady clock time of the request, to measure how long the simulation took to stop.
+    std::atomic<long long> requestNanoseconds;
+
+public:
+    CancellationToken();
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    /**
+     * @brief Asks the run in flight to stop. It is dropped when no run is in flight, and only the first request of
+     * a run is timed.
+     */
+    void request();
+
+    /**
+     * @brief Marks a run as in flight, with no request yet.
+     */
+    void begin();
+
+    /**
+     * @brief Marks the run as finished, so the requests that come later are dropped. The last request, if any, is
+     * kept until the next run begins or the token is reset.
+     */
+    void end();
+
+    /**
+     * @brief Clears the last request, without starting a run.
+     */
+    void reset();
+
+    /**
+     * @brief Returns true once a stop was requested during the current or last run.
+     */
+    inline bool isRequested() const { return this->requested.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the seconds since the stop was requested, or zero if it was not.
+     */
+    double getSecondsSinceRequest() const;
+};
+
+#endif // CANCELLATIONTOKEN_H
@@ -0,0 +1,208 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+#include "BinaryGridFile.h"
+#include "CheckpointWriter.h"
+#include "MappedFile.h"
+#include "TemperatureGrid.h"
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Size of the text of a value written in hexadecimal floating point.
+#define STATE_VALUE_SIZE 40
+
+/**
+ * @brief Returns the value as hexadecimal floating point text, which reads back as exactly the same value.
+ */
+static std::string formatValue(double value)
+{
+    char text[STATE_VALUE_SIZE];
+    std::snprintf(text, sizeof(text), "%a", value);
+    return text;
+}
+
+/**
+ * @brief Reads a value written by formatValue().
+ * @return false if the text is not a number.
+ */
+static bool parseValue(const std::string& text, double& value)
+{
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0';
+}
+
+CheckpointWriter::CheckpointWriter()
+{
+    this->matrix = new TemperatureGrid();
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+    if( this->thread.joinable() )
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+        this->changed.notify_all();
+        this->thread.join();
+    }
+    delete this->matrix;
+}
+
+bool CheckpointWriter::isBusy()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->writing;
+}
+
+TemperatureGrid& CheckpointWriter::getMatrix()
+{
+    return *this->matrix;
+}
+
+void CheckpointWriter::submit(const std::string& filePath, const State& state)
+{
+    // The thread is only started by the first checkpoint, so engines that never write one do not keep it.
+    if( !this->thread.joinable() )
+        this->thread = std::thread(&CheckpointWriter::run, this);
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->filePath = filePath;
+        this->state = state;
+        this->writing = true;
+    }
+    this->changed.notify_all();
+}
+
+bool CheckpointWriter::wait()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->changed.wait( lock, [this]() { return !this->writing; } );
+    return this->lastWritten;
+}
+
+size_t CheckpointWriter::getWrittenGeneration()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->writtenGeneration;
+}
+
+bool CheckpointWriter::write(const std::string& filePath, const TemperatureGrid& matrix, const State& state)
+{
+    // The state follows the cells, where a binary grid file may have anything, and the doubles are written in
+    // hexadecimal so they read back exactly.
+    const std::string temporaryPath = filePath + ".tmp";
+    if( !BinaryGridFile::write(temporaryPath, matrix, BinaryGridFile::FLOAT64) )
+        return false;
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::app);
+        file << '\n' << CHECKPOINT_SIGNATURE << '\n'
+             << "solver " << getSolverName(state.solver) << '\n'
+             << "epsilon " << formatValue(state.epsilon) << '\n'
+             << "relaxation_factor " << formatValue(state.relaxationFactor) << '\n'
+             << "generation " << state.generationCount << '\n'
+             << "solve_seconds " << formatValue(state.solveSeconds) << '\n';
+        file.close();
+        if( !file )
+            return false;
+    }
+
+#ifdef __unix__
+    // The new checkpoint must be on the disk before it replaces the old one.
+    const int descriptor = ::open(temporaryPath.c_str(), O_RDONLY);
+    if( descriptor < 0 )
+        return false;
+    const bool synchronized = ::fsync(descriptor) == 0;
+    ::close(descriptor);
+    if( !synchronized )
+        return false;
+#endif
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, filePath, error);
+    return !error;
+}
+
+bool CheckpointWriter::read(const std::string& filePath, TemperatureGrid& matrix, State& state)
+{
+    MappedFile file;
+    BinaryGridFile::Layout layout;
+    // The matrix of a checkpoint is copied into the engine anyway, so hashing it on the way costs no extra reads.
+    if( !file.open(filePath) || !BinaryGridFile::inspect(file, layout, true) || layout.dataType != BinaryGridFile::FLOAT64 )
+        return false;
+
+    const size_t cellCount = layout.rows > 0 ? (layout.rows - 1) * layout.stride + layout.columns : 0;
+    const size_t stateOffset = layout.firstCellOffset + cellCount * sizeof(double);
+    std::istringstream text( std::string( file.getData() + stateOffset, file.getSize() - stateOffset ) );
+    std::string line;
+    std::getline(text, line);
+    if( !std::getline(text, line) || line != CHECKPOINT_SIGNATURE )
+        return false;
+
+    // Every field must be there, in any order.
+    int fieldCount = 0;
+    std::string key;
+    std::string value;
+    while( text >> key >> value )
+    {
+        if( key == "solver" )
+        {
+            state.solver = getSolverByName( value.c_str() );
+            fieldCount += state.solver != SOLVER_COUNT;
+        }
+        else if( key == "epsilon" )
+            fieldCount += parseValue(value, state.epsilon);
+        else if( key == "relaxation_factor" )
+            fieldCount += parseValue(value, state.relaxationFactor);
+        else if( key == "generation" )
+        {
+            char* end = nullptr;
+            state.generationCount = static_cast<size_t>( std::strtoull(value.c_str(), &end, 10) );
+            fieldCount += *end == '\0';
+        }
+        else if( key == "solve_seconds" )
+            fieldCount += parseValue(value, state.solveSeconds);
+    }
+    if( fieldCount != 5 )
+        return false;
+
+    // The cells are copied from the mapping the state was read from. Mapping the path again could pick up a newer
+    // checkpoint renamed over it meanwhile, whose cells would not match the state.
+    const char* cells = file.getData() + layout.firstCellOffset;
+    matrix.reshape(layout.rows, layout.columns);
+    for( size_t row = 0; row < layout.rows; ++row )
+        std::memcpy( matrix.row(row), cells + row * layout.stride * sizeof(double), layout.columns * sizeof(double) );
+    return true;
+}
+
+void CheckpointWriter::run()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while( true )
+    {
+        // A checkpoint submitted before the writer is destroyed is still written.
+        this->changed.wait( lock, [this]() { return this->writing || this->stopping; } );
+        if( !this->writing )
+            return;
+
+        const std::string filePath = this->filePath;
+        const State state = this->state;
+        lock.unlock();
+        const bool written = write(filePath, *this->matrix, state);
+        lock.lock();
+        this->lastWritten = written;
+        if( written )
+            this->writtenGeneration = state.generationCount;
+        this->writing = false;
+        this->changed.notify_all();
+    }
+}
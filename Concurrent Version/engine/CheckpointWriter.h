@@ -0,0 +1,111 @@
+#ifndef CHECKPOINTWRITER_H
+#define CHECKPOINTWRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Solver.h"
+
+// Extension of the checkpoints. A checkpoint is a binary grid file, so it can be opened wherever one can.
+#define CHECKPOINT_EXTENSION ".checkpoint"
+// First line of the state stored after the cells of a checkpoint.
+#define CHECKPOINT_SIGNATURE "HEATCHECKPOINT 1"
+// Seconds between two checkpoints of a running simulation when none are given.
+#define CHECKPOINT_DEFAULT_INTERVAL 60.0
+
+class TemperatureGrid;
+
+/**
+ * Writes checkpoints of a running simulation from its own thread, so the workers never wait for the disk. A
+ * checkpoint is a binary grid file of the last completed generation, followed by the state the simulation needs
+ * to continue from it: the solver, the epsilon, the relaxation factor and the counters. The writer keeps the matrix
+ * of the next checkpoint, which the caller fills before submitting it. The engine has its workers fill it tile by
+ * tile during the next phase, each one before updating the tile, so none of them waits for a copy of the whole
+ * matrix. Every checkpoint is written to a temporary file that replaces the previous one once complete, so a crash
+ * leaves the old one intact.
+ */
+class CheckpointWriter
+{
+public:
+    /**
+     * @brief What a simulation needs, besides its matrix, to continue bit-exactly from a checkpoint.
+     */
+    struct State
+    {
+        Solver solver = JACOBI_SOLVER;
+        double epsilon = 0.0;
+        double relaxationFactor = 1.0;
+        size_t generationCount = 0;
+        double solveSeconds = 0.0;
+    };
+
+private:
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable changed;
+    TemperatureGrid * matrix = nullptr;
+    std::string filePath;
+    State state;
+    bool writing = false;
+    bool stopping = false;
+    bool lastWritten = true;
+    size_t writtenGeneration = 0;
+
+public:
+    CheckpointWriter();
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+    ~CheckpointWriter();
+
+    /**
+     * @brief Returns true while a checkpoint is being written.
+     */
+    bool isBusy();
+
+    /**
+     * @brief Returns the matrix the next checkpoint is written from. It must only be filled while isBusy() is false.
+     */
+    TemperatureGrid& getMatrix();
+
+    /**
+     * @brief Starts writing the matrix returned by getMatrix() in the background. It must not be called while
+     * isBusy() is true.
+     * @param filePath Path of the checkpoint, replaced once the new one is complete.
+     * @param state State of the simulation after the generation in the matrix.
+     */
+    void submit(const std::string& filePath, const State& state);
+
+    /**
+     * @brief Waits until the last checkpoint submitted is written.
+     * @return false if it could not be written.
+     */
+    bool wait();
+
+    /**
+     * @brief Returns the generation of the last checkpoint written, or zero if none was.
+     */
+    size_t getWrittenGeneration();
+
+    /**
+     * @brief Writes a checkpoint in the calling thread, through a temporary file that replaces the given one.
+     * @return false if the file could not be written.
+     */
+    static bool write(const std::string& filePath, const TemperatureGrid& matrix, const State& state);
+
+    /**
+     * @brief Reads a checkpoint written by write().
+     * @return false if the file is not a valid checkpoint.
+     */
+    static bool read(const std::string& filePath, TemperatureGrid& matrix, State& state);
+
+private:
+    /**
+     * @brief Body of the writer thread: writes every checkpoint submitted until the writer is destroyed.
+     */
+    void run();
+};
+
+#endif // CHECKPOINTWRITER_H
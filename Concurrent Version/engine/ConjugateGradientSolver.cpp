@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ConjugateGradientSolver.h"
+
+const char* ConjugateGradientSolver::getPreconditionerName(Preconditioner preconditioner)
+{
+    static const char* const names[] = { "jacobi", "ssor", "ic" };
+    return ( preconditioner >= JACOBI_PRECONDITIONER && preconditioner < PRECONDITIONER_COUNT ) ? names[preconditioner] : "unknown";
+}
+
+ConjugateGradientSolver::ConjugateGradientSolver()
+{}
+
+void ConjugateGradientSolver::setup(TemperatureGrid * matrix, Preconditioner preconditioner, size_t slotCount)
+{
+    this->matrix = matrix;
+    this->preconditioner = preconditioner;
+    this->partialSums.assign( std::max(slotCount, static_cast<size_t>(1)), PartialSums() );
+    this->iterationCount = 0;
+
+    // The border of the vectors stays zero, so the stencil needs no bound checks. Only the matrix has the real border.
+    const size_t rows = matrix->getNumberOfRows();
+    const size_t columns = matrix->getNumberOfColumns();
+    this->residual.resize(rows, columns);
+    this->direction.resize(rows, columns);
+    this->product.resize(rows, columns);
+    this->preconditioned.resize(rows, columns);
+    this->restart();
+}
+
+void ConjugateGradientSolver::restart()
+{
+    this->alpha = this->beta = 0.0;
+    this->residualProduct = this->residualNorm = this->maximumResidual = 0.0;
+
+    // The border is the right hand side, so the residual of the interior is the usual sum of neighbours minus four times the cell.
+    const size_t stride = this->matrix->getStride();
+    for( size_t row = 0; row < this->matrix->getInteriorRows(); ++row )
+    {
+        const double* center = this->matrix->interior(row);
+        double* target = this->residual.interior(row);
+        for( size_t column = 0; column < this->matrix->getInteriorColumns(); ++column )
+            target[column] = center[column + 1] + center[column - 1] + center[column - stride] + center[column + stride] - 4.0 * center[column];
+    }
+
+    // The first pass only applies the preconditioner to the initial residual, since alpha is zero.
+    this->phase = UPDATE_PHASE;
+}
+
+void ConjugateGradientSolver::setSlotCount(size_t slotCount)
+{
+    this->partialSums.assign( std::max(slotCount, static_cast<size_t>(1)), PartialSums() );
+}
+
+void ConjugateGradientSolver::runPhase(size_t startRow, size_t finishRow, size_t startColumn, size_t finishColumn, size_t slot)
+{
+    PartialSums& sums = this->partialSums[slot];
+    sums = PartialSums();
+    const size_t stride = this->direction.getStride();
+
+    for( size_t row = startRow; row < finishRow; ++row )
+    {
+        double* solution = this->matrix->interior(row);
+        double* residual = this->residual.interior(row);
+        double* direction = this->direction.interior(row);
+        double* product = this->product.interior(row);
+        double* preconditioned = this->preconditioned.interior(row);
+
+        switch( this->phase )
+        {
+        case DIRECTION_PHASE:
+            for( size_t column = startColumn; column < finishColumn; ++column )
+                direction[column] = preconditioned[column] + this->beta * direction[column];
+            break;
+
+        case MULTIPLY_PHASE:
+            for( size_t column = startColumn; column < finishColumn; ++column )
+            {
+                const double sum = direction[column + 1] + direction[column - 1] + direction[column - stride] + direction[column + stride];
+                product[column] = 4.0 * direction[column] - sum;
+                sums.product += direction[column] * product[column];
+            }
+            break;
+
+        case UPDATE_PHASE:
+            for( size_t column = startColumn; column < finishColumn; ++column )
+            {
+                solution[column] += this->alpha * direction[column];
+                residual[column] -= this->alpha * product[column];
+                sums.squaredResidual += residual[column] * residual[column];
+                sums.maximumResidual = std::max( sums.maximumResidual, std::fabs(residual[column]) );
+            }
+            if( this->preconditioner == JACOBI_PRECONDITIONER )
+            {
+                for( size_t column = startColumn; column < finishColumn; ++column )
+                {
+                    preconditioned[column] = residual[column] * 0.25;
+                    sums.product += residual[column] * preconditioned[column];
+                }
+            }
+            else
+            {
+                // The red cells have no earlier neighbours in the forward sweep, so they only need their own residual.
+                for( size_t column = startColumn + ((row + startColumn) & 1); column < finishColumn; column += 2 )
+                    preconditioned[column] = residual[column] * 0.25;
+            }
+            break;
+
+        case BLACK_PHASE:
+            // The forward sweep reaches the black cells after all their red neighbours, and the backward sweep starts
+            // with them, so their value is final once the forward sweep computes it.
+            for( size_t column = startColumn + ((row + startColumn + 1) & 1); column < finishColumn; column += 2 )
+            {
+                const double sum = preconditioned[column + 1] + preconditioned[column - 1] + preconditioned[column - stride] + preconditioned[column + stride];
+                preconditioned[column] = ( residual[column] + sum ) / this->getBlackPivot(row, column);
+            }
+            break;
+
+        case RED_PHASE:
+            for( size_t column = startColumn + ((row + startColumn) & 1); column < finishColumn; column += 2 )
+            {
+                const double sum = preconditioned[column + 1] + preconditioned[column - 1] + preconditioned[column - stride] + preconditioned[column + stride];
+                preconditioned[column] += sum * 0.25;
+            }
+            for( size_t column = startColumn; column < finishColumn; ++column )
+                sums.product += residual[column] * preconditioned[column];
+            break;
+        }
+    }
+}
+
+bool ConjugateGradientSolver::finishPhase()
+{
+    double product = 0.0;
+    double squaredResidual = 0.0;
+    double maximumResidual = 0.0;
+    for( const PartialSums& sums : this->partialSums )
+    {
+        product += sums.product;
+        squaredResidual += sums.squaredResidual;
+        maximumResidual = std::max(maximumResidual, sums.maximumResidual);
+    }
+
+    switch( this->phase )
+    {
+    case DIRECTION_PHASE:
+        this->phase = MULTIPLY_PHASE;
+        return false;
+
+    case MULTIPLY_PHASE:
+        this->alpha = product > 0.0 ? this->residualProduct / product : 0.0;
+        this->phase = UPDATE_PHASE;
+        return false;
+
+    case UPDATE_PHASE:
+        this->residualNorm = std::sqrt(squaredResidual);
+        this->maximumResidual = maximumResidual;
+        if( this->preconditioner != JACOBI_PRECONDITIONER )
+        {
+            this->phase = BLACK_PHASE;
+            return false;
+        }
+        break;
+
+    case BLACK_PHASE:
+        this->phase = RED_PHASE;
+        return false;
+
+    case RED_PHASE:
+        break;
+    }
+
+    // The first pass has no previous residual product, so the first direction is the preconditioned residual.
+    this->beta = this->residualProduct > 0.0 ? product / this->residualProduct : 0.0;
+    if( this->residualProduct > 0.0 )
+        ++this->iterationCount;
+    this->residualProduct = product;
+    this->phase = DIRECTION_PHASE;
+    return true;
+}
+
+double ConjugateGradientSolver::getMaximumDelta() const
+{
+    return this->maximumResidual / 4.0;
+}
+
+double ConjugateGradientSolver::getResidualNorm() const
+{
+    return this->residualNorm;
+}
+
+size_t ConjugateGradientSolver::getIterationCount() const
+{
+    return this->iterationCount;
+}
+
+size_t ConjugateGradientSolver::countInteriorNeighbors(size_t row, size_t column) const
+{
+    const size_t lastRow = this->matrix->getInteriorRows() - 1;
+    const size_t lastColumn = this->matrix->getInteriorColumns() - 1;
+    return 4 - (row == 0) - (row == lastRow) - (column == 0) - (column == lastColumn);
+}
+
+double ConjugateGradientSolver::getBlackPivot(size_t row, size_t column) const
+{
+    // Eliminating each red neighbour subtracts 1 * 1 / 4 from the diagonal. SSOR keeps the diagonal instead.
+    if( this->preconditioner == INCOMPLETE_CHOLESKY_PRECONDITIONER )
+        return 4.0 - 0.25 * this->countInteriorNeighbors(row, column);
+    return 4.0;
+}
@@ -0,0 +1,145 @@
+#ifndef CONJUGATEGRADIENTSOLVER_H
+#define CONJUGATEGRADIENTSOLVER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "TemperatureGrid.h"
+
+/**
+ * Matrix-free preconditioned conjugate gradient for the interior Laplace system, 4 u - (sum of the neighbours) = 0
+ * with the border held fixed. An iteration is split in phases, so the workers can run each phase on their own tiles
+ * and meet between them. Every tile leaves its partial dot products in its own slot, and finishPhase() adds
+ * them in tile order, so the result does not depend on which worker runs each tile or finishes first.
+ */
+class ConjugateGradientSolver
+{
+public:
+    /**
+     * @brief Approximate inverse applied to the residual on every iteration.
+     */
+    enum Preconditioner
+    {
+        // Divides the residual by the diagonal.
+        JACOBI_PRECONDITIONER,
+        // A forward and a backward Gauss-Seidel sweep in red-black order, so each colour can be split among workers.
+        SSOR_PRECONDITIONER,
+        // Incomplete Cholesky without fill-in, in red-black order. Only the pivots of the black cells change.
+        INCOMPLETE_CHOLESKY_PRECONDITIONER,
+        PRECONDITIONER_COUNT
+    };
+
+    /**
+     * @brief Returns the name used to select the given preconditioner from the command line.
+     */
+    static const char* getPreconditionerName(Preconditioner preconditioner);
+
+private:
+    /**
+     * @brief Steps of an iteration. Each one reads the cells the previous one wrote in the rows of other workers.
+     */
+    enum Phase
+    {
+        // p = z + beta p
+        DIRECTION_PHASE,
+        // q = A p, and the partial p . q
+        MULTIPLY_PHASE,
+        // x += alpha p and r -= alpha q, then the preconditioner on the cells that only need r
+        UPDATE_PHASE,
+        // The black cells of both red-black sweeps
+        BLACK_PHASE,
+        // The red cells of the backward sweep, and the partial r . z
+        RED_PHASE
+    };
+
+    /**
+     * Sums calculated by a worker on its rows, padded to a cache line so workers do not share one.
+     */
+    struct alignas(64) PartialSums
+    {
+        double product = 0.0;
+        double squaredResidual = 0.0;
+        double maximumResidual = 0.0;
+    };
+
+    TemperatureGrid * matrix = nullptr;
+    Preconditioner preconditioner = JACOBI_PRECONDITIONER;
+    Phase phase = DIRECTION_PHASE;
+
+    TemperatureGrid residual;
+    TemperatureGrid direction;
+    TemperatureGrid product;
+    TemperatureGrid preconditioned;
+    std::vector<PartialSums> partialSums;
+
+    double alpha = 0.0;
+    double beta = 0.0;
+    double residualProduct = 0.0;
+    double residualNorm = 0.0;
+    double maximumResidual = 0.0;
+    size_t iterationCount = 0;
+
+public:
+    ConjugateGradientSolver();
+
+    /**
+     * @brief Calculates the initial residual of the matrix, which is updated in place by the iterations.
+     * @param matrix Matrix whose border is held fixed. Its interior is the initial guess.
+     * @param preconditioner Preconditioner applied on every iteration.
+     * @param slotCount Number of slots for partial sums, one per tile passed to runPhase().
+     */
+    void setup(TemperatureGrid * matrix, Preconditioner preconditioner, size_t slotCount);
+
+    /**
+     * @brief Starts the iterations over from the current matrix, keeping the iteration count. An iteration cut
+     * half way leaves the vectors out of step with the matrix, but any matrix is a valid initial guess.
+     */
+    void restart();
+
+    /**
+     * @brief Changes the number of slots for partial sums between two phases, without restarting the iterations.
+     */
+    void setSlotCount(size_t slotCount);
+
+    /**
+     * @brief Runs the current phase on the given interior rectangle, from the start row and column to the cell
+     * before the finish ones.
+     * @param slot Slot where the partial sums of the rectangle are left. Each slot must be used once per phase.
+     */
+    void runPhase(size_t startRow, size_t finishRow, size_t startColumn, size_t finishColumn, size_t slot);
+
+    /**
+     * @brief Adds the partial sums of every tile and moves to the next phase. Must be called once all of them
+     * finished the current phase.
+     * @return true if an iteration was completed, so the residual is up to date.
+     */
+    bool finishPhase();
+
+    /**
+     * @brief Returns the largest change a Jacobi generation would make, comparable with the epsilon of the other solvers.
+     */
+    double getMaximumDelta() const;
+
+    /**
+     * @brief Returns the Euclidean norm of the residual after the last iteration.
+     */
+    double getResidualNorm() const;
+
+    /**
+     * @brief Returns the number of iterations completed since setup().
+     */
+    size_t getIterationCount() const;
+
+private:
+    /**
+     * @brief Returns the number of interior neighbours of an interior cell, the ones that are unknowns of the system.
+     */
+    size_t countInteriorNeighbors(size_t row, size_t column) const;
+
+    /**
+     * @brief Returns the pivot of a black cell in the forward sweep of the preconditioner.
+     */
+    double getBlackPivot(size_t row, size_t column) const;
+};
+
+#endif // CONJUGATEGRADIENTSOLVER_H
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cmath>
+
+#include "FastPoissonSolver.h"
+#include "TemperatureGrid.h"
+
+FastPoissonSolver::FastPoissonSolver()
+{}
+
+void FastPoissonSolver::solve(TemperatureGrid& matrix)
+{
+    const size_t rows = matrix.getInteriorRows();
+    const size_t columns = matrix.getInteriorColumns();
+    if( rows == 0 || columns == 0 )
+        return;
+
+    // 4 u - (sum of the interior neighbours) = sum of the border neighbours, so the right hand side is the border.
+    for( size_t row = 0; row < rows; ++row )
+    {
+        double* cells = matrix.interior(row);
+        std::fill(cells, cells + columns, 0.0);
+        cells[0] += cells[-1];
+        cells[columns - 1] += cells[columns];
+    }
+    for( size_t column = 0; column < columns; ++column )
+    {
+        matrix.interior(0)[column] += matrix.row(0)[column + 1];
+        matrix.interior(rows - 1)[column] += matrix.row(rows + 1)[column + 1];
+    }
+
+    // The sine transform diagonalizes the second difference along a row: frequency k turns it into 2 cos(pi k / (N + 1)).
+    if( this->sineTransform.getLength() != columns )
+        this->sineTransform.resize(columns);
+    const double pi = std::acos(-1.0);
+    this->diagonals.resize(columns);
+    for( size_t column = 0; column < columns; ++column )
+        this->diagonals[column] = 4.0 - 2.0 * std::cos( pi * (column + 1) / (columns + 1) );
+
+    for( size_t row = 0; row < rows; row += 2 )
+        this->sineTransform.transform( matrix.interior(row), row + 1 < rows ? matrix.interior(row + 1) : nullptr );
+
+    // Every frequency leaves diagonal * u[j] - u[j - 1] - u[j + 1] = b[j] along the columns. The Thomas algorithm
+    // solves all of them at once row by row, so the matrix is read contiguously. The diagonal is above 2, so it is stable.
+    this->pivots.resize(rows * columns);
+    for( size_t column = 0; column < columns; ++column )
+        this->pivots[column] = 1.0 / this->diagonals[column];
+    double* cells = matrix.interior(0);
+    for( size_t column = 0; column < columns; ++column )
+        cells[column] *= this->pivots[column];
+    for( size_t row = 1; row < rows; ++row )
+    {
+        const double* above = matrix.interior(row - 1);
+        double* current = matrix.interior(row);
+        const double* abovePivots = &this->pivots[(row - 1) * columns];
+        double* currentPivots = &this->pivots[row * columns];
+        for( size_t column = 0; column < columns; ++column )
+        {
+            currentPivots[column] = 1.0 / ( this->diagonals[column] - abovePivots[column] );
+            current[column] = ( current[column] + above[column] ) * currentPivots[column];
+        }
+    }
+    for( size_t row = rows - 1; row-- > 0; )
+    {
+        const double* below = matrix.interior(row + 1);
+        double* current = matrix.interior(row);
+        const double* currentPivots = &this->pivots[row * columns];
+        for( size_t column = 0; column < columns; ++column )
+            current[column] += currentPivots[column] * below[column];
+    }
+
+    const double scale = 2.0 / (columns + 1);
+    for( size_t row = 0; row < rows; row += 2 )
+        this->sineTransform.transform( matrix.interior(row), row + 1 < rows ? matrix.interior(row + 1) : nullptr );
+    for( size_t row = 0; row < rows; ++row )
+    {
+        double* values = matrix.interior(row);
+        for( size_t column = 0; column < columns; ++column )
+            values[column] *= scale;
+    }
+}
+
+double FastPoissonSolver::getMaximumDelta(const TemperatureGrid& matrix)
+{
+    const size_t stride = matrix.getStride();
+    double maximumDelta = 0.0;
+    for( size_t row = 0; row < matrix.getInteriorRows(); ++row )
+    {
+        const double* center = matrix.interior(row);
+        for( size_t column = 0; column < matrix.getInteriorColumns(); ++column )
+        {
+            const double sum = center[column + 1] + center[column - 1] + center[column - stride] + center[column + stride];
+            maximumDelta = std::max( maximumDelta, std::fabs(sum * 0.25 - center[column]) );
+        }
+    }
+    return maximumDelta;
+}
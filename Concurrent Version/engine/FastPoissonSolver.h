@@ -0,0 +1,38 @@
+#ifndef FASTPOISSONSOLVER_H
+#define FASTPOISSONSOLVER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "SineTransform.h"
+
+class TemperatureGrid;
+
+/**
+ * Computes the equilibrium state of a matrix in one shot, without iterating. The border is moved to the right
+ * hand side of the five point Laplace equation, and a sine transform along the rows decouples it into one
+ * tridiagonal system per frequency, which is solved along the columns. The cost is O(N log N) in the cells.
+ */
+class FastPoissonSolver
+{
+private:
+    SineTransform sineTransform;
+    std::vector<double> diagonals;
+    std::vector<double> pivots;
+
+public:
+    FastPoissonSolver();
+
+    /**
+     * @brief Replaces the interior of the matrix with the solution of Laplace's equation for its border.
+     * @param matrix Matrix whose border is held fixed.
+     */
+    void solve(TemperatureGrid& matrix);
+
+    /**
+     * @brief Returns the largest change a Jacobi generation would make to the matrix, to check the solution.
+     */
+    static double getMaximumDelta(const TemperatureGrid& matrix);
+};
+
+#endif // FASTPOISSONSOLVER_H
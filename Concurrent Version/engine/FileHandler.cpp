@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "FileHandler.h"
+#include "MappedFile.h"
+#include "TemperatureGrid.h"
+
+// Longest text of a value written by saveFile(), terminator included.
+#define FORMATTED_VALUE_SIZE 32
+
+static bool isSpace(char character)
+{
+    return std::isspace( static_cast<unsigned char>(character) ) != 0;
+}
+
+/**
+ * @brief Writes the shortest text that reads back as the given value, and returns its length.
+ */
+static size_t formatValue(double value, char* text)
+{
+#if defined(__cpp_lib_to_chars)
+    return static_cast<size_t>( std::to_chars(text, text + FORMATTED_VALUE_SIZE, value).ptr - text );
+#else
+    return static_cast<size_t>( std::snprintf(text, FORMATTED_VALUE_SIZE, "%.17g", value) );
+#endif
+}
+
+/**
+ * @brief Runs the task once for every chunk, the first one in the calling thread and each other one in a thread of its own.
+ */
+static void runChunks(size_t chunkCount, const std::function<void(size_t)>& task)
+{
+    std::vector<std::thread> threads;
+    for( size_t chunk = 1; chunk < chunkCount; ++chunk )
+        threads.emplace_back(task, chunk);
+    task(0);
+    for( std::thread& thread : threads )
+        thread.join();
+}
+
+FileHandler::FileHandler()
+{}
+
+bool FileHandler::processFile(const std::string& filePath, TemperatureGrid &targetMatrix)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    MappedFile file;
+    if( !file.open(filePath) )
+        return false;
+
+    bool loaded = true;
+    this->lastRaggedRowCount = 0;
+    if( BinaryGridFile::hasSignature(file.getData(), file.getSize()) )
+        loaded = BinaryGridFile::read(filePath, file, targetMatrix, this->checksumVerification);
+    else
+        this->lastRaggedRowCount = this->parseText(file, targetMatrix);
+
+    this->lastLoadBytes = file.getSize();
+    this->lastLoadSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    return loaded;
+}
+
+bool FileHandler::saveFile(const std::string& filePath, const TemperatureGrid& sourceMatrix, BinaryGridFile::DataType dataType) const
+{
+    const std::string extension = BINARY_GRID_EXTENSION;
+    if( filePath.size() >= extension.size() && filePath.compare(filePath.size() - extension.size(), extension.size(), extension) == 0 )
+        return BinaryGridFile::write(filePath, sourceMatrix, dataType);
+
+    std::ofstream file(filePath, std::ios::binary);
+    if( !file.is_open() )
+        return false;
+    std::string line;
+    char text[FORMATTED_VALUE_SIZE];
+    for( size_t currentRow = 0; currentRow < sourceMatrix.getNumberOfRows(); ++currentRow )
+    {
+        line.clear();
+        const double* cells = sourceMatrix.row(currentRow);
+        for( size_t column = 0; column < sourceMatrix.getNumberOfColumns(); ++column )
+        {
+            if( column > 0 )
+                line += ',';
+            line.append( text, formatValue(cells[column], text) );
+        }
+        line += '\n';
+        file.write( line.data(), static_cast<std::streamsize>( line.size() ) );
+    }
+    return static_cast<bool>(file);
+}
+
+void FileHandler::setThreadCount(int threadCount)
+{
+    this->threadCount = std::max(threadCount, 0);
+}
+
+void FileHandler::setChecksumVerification(bool checksumVerification)
+{
+    this->checksumVerification = checksumVerification;
+}
+
+double FileHandler::getLastThroughput() const
+{
+    return this->lastLoadSeconds > 0.0 ? static_cast<double>(this->lastLoadBytes) / 1e6 / this->lastLoadSeconds : 0.0;
+}
+
+size_t FileHandler::getLastRaggedRowCount() const
+{
+    return this->lastRaggedRowCount;
+}
+
+size_t FileHandler::parseText(const MappedFile& file, TemperatureGrid& targetMatrix) const
+{
+    const char* data = file.getData();
+    const size_t size = file.getSize();
+    const char* end = data + size;
+    const size_t hardwareThreads = std::max( static_cast<size_t>( std::thread::hardware_concurrency() ), static_cast<size_t>(1) );
+    const size_t threads = this->threadCount > 0 ? static_cast<size_t>(this->threadCount) : hardwareThreads;
+    const size_t chunkCount = std::max( std::min(threads, size / FILE_MINIMUM_CHUNK_BYTES), static_cast<size_t>(1) );
+
+    // Every chunk but the first starts at the first line that begins within or after its share of the bytes, so no line is split.
+    std::vector<const char*> chunkStarts(chunkCount + 1, end);
+    chunkStarts[0] = data;
+    for( size_t chunk = 1; chunk < chunkCount; ++chunk )
+    {
+        const char* share = data + size / chunkCount * chunk;
+        const char* lineBreak = static_cast<const char*>( std::memchr(share - 1, '\n', static_cast<size_t>(end - share) + 1) );
+        chunkStarts[chunk] = std::max( lineBreak != nullptr ? lineBreak + 1 : end, chunkStarts[chunk - 1] );
+    }
+
+    std::vector<size_t> firstRows(chunkCount + 1, 0);
+    runChunks(chunkCount, [&chunkStarts, &firstRows](size_t chunk)
+    {
+        firstRows[chunk + 1] = countLines(chunkStarts[chunk], chunkStarts[chunk + 1]);
+    });
+    for( size_t chunk = 0; chunk < chunkCount; ++chunk )
+        firstRows[chunk + 1] += firstRows[chunk];
+
+    const size_t rowCount = firstRows[chunkCount];
+    const char* firstBreak = size > 0 ? static_cast<const char*>( std::memchr(data, '\n', size) ) : nullptr;
+    const size_t columnCount = rowCount > 0 ? static_cast<size_t>( std::count(data, firstBreak != nullptr ? firstBreak : end, ',') ) + 1 : 0;
+
+    // Every cell is written below, so the grid is allocated once without being filled first.
+    targetMatrix.reshape(rowCount, columnCount);
+    std::vector<size_t> raggedRowCounts(chunkCount, 0);
+    runChunks(chunkCount, [&chunkStarts, &firstRows, &raggedRowCounts, columnCount, &targetMatrix](size_t chunk)
+    {
+        raggedRowCounts[chunk] = parseRows(chunkStarts[chunk], chunkStarts[chunk + 1], columnCount, targetMatrix, firstRows[chunk]);
+    });
+
+
+    size_t raggedRowCount = 0;
+    for( size_t chunkRaggedRowCount : raggedRowCounts )
+        raggedRowCount += chunkRaggedRowCount;
+    return raggedRowCount;
+}
+
+size_t FileHandler::countLines(const char* begin, const char* end)
+{
+    size_t lineCount = 0;
+    for( const char* cursor = begin; cursor < end; ++lineCount )
+    {
+        const char* lineBreak = static_cast<const char*>( std::memchr(cursor, '\n', static_cast<size_t>(end - cursor)) );
+        cursor = lineBreak != nullptr ? lineBreak + 1 : end;
+    }
+    return lineCount;
+}
+
+size_t FileHandler::parseRows(const char* begin, const char* end, size_t columnCount, TemperatureGrid& targetMatrix, size_t firstRow)
+{
+    size_t raggedRowCount = 0;
+    size_t currentRow = firstRow;
+    for( const char* line = begin; line < end; ++currentRow )
+    {
+        bool ragged = false;
+        line = parseRow(line, end, columnCount, targetMatrix.row(currentRow), ragged);
+        if( ragged )
+            ++raggedRowCount;
+    }
+    return raggedRowCount;
+}
+
+const char* FileHandler::parseRow(const char* line, const char* end, size_t columnCount, double* cells, bool& ragged)
+{
+    const char* lineBreak = static_cast<const char*>( std::memchr(line, '\n', static_cast<size_t>(end - line)) );
+    const char* next = lineBreak != nullptr ? lineBreak + 1 : end;
+    size_t lineSize = static_cast<size_t>( (lineBreak != nullptr ? lineBreak : end) - line );
+
+    // Files written on Windows end their lines with a carriage return.
+    if( lineSize > 0 && line[lineSize - 1] == '\r' )
+        --lineSize;
+
+    size_t elementStart = 0;
+    ragged = false;
+    for( size_t currentElement = 0; currentElement < columnCount; ++currentElement )
+    {
+        if( elementStart > lineSize )
+        {
+            cells[currentElement] = 0.0;
+            ragged = true;
+            continue;
+        }
+
+        const char* elementFinish = static_cast<const char*>( std::memchr(line + elementStart, ',', lineSize - elementStart) );
+        const size_t elementSize = elementFinish != nullptr ? static_cast<size_t>(elementFinish - line) - elementStart : lineSize - elementStart;
+        cells[currentElement] = parseElement(line + elementStart, line + elementStart + elementSize);
+        elementStart += elementSize + 1;
+    }
+    // Elements left after the last column are dropped.
+    if( elementStart <= lineSize )
+        ragged = true;
+    return next;
+}
+
+double FileHandler::parseElement(const char* begin, const char* end)
+{
+#if defined(__cpp_lib_to_chars)
+    // Plain decimal numbers, nearly every element, are parsed in place. from_chars takes neither leading spaces nor
+    // a plus sign, so they are skipped here as strtod does.
+    const char* number = begin;
+    while( number < end && isSpace(*number) )
+        ++number;
+    const char* digits = number;
+    if( digits < end && *digits == '+' )
+        number = ++digits;
+    else if( digits < end && *digits == '-' )
+        ++digits;
+    if( digits < end && (std::isdigit( static_cast<unsigned char>(*digits) ) || *digits == '.') )
+    {
+        double value = 0.0;
+        const std::from_chars_result result = std::from_chars(number, end, value);
+        const char* rest = result.ptr;
+        while( rest < end && isSpace(*rest) )
+            ++rest;
+        if( result.ec == std::errc() && rest == end )
+            return value;
+    }
+#endif
+
+    // Infinities, hexadecimal numbers, values out of range and anything malformed go through strtod, so every
+    // element gets the same value it always did.
+    const std::string element(begin, end);
+    char* finish = nullptr;
+    double value = std::strtod(element.c_str(), &finish);
+    while( *finish != '\0' && isSpace(*finish) )
+        ++finish;
+    if( finish == element.c_str() || *finish != '\0' )
+        value = 0.0;
+    return value;
+}
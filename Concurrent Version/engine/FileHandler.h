@@ -0,0 +1,114 @@
+#ifndef FILEHANDLER_H
+#define FILEHANDLER_H
+
+#include <string>
+
+#include "BinaryGridFile.h"
+
+// Fewest bytes parsed by each thread, so small files are not split among threads that take longer to start.
+#define FILE_MINIMUM_CHUNK_BYTES (1 << 20)
+
+class MappedFile;
+class TemperatureGrid;
+
+class FileHandler
+{
+private:
+    int threadCount = 0;
+    bool checksumVerification = false;
+    size_t lastLoadBytes = 0;
+    double lastLoadSeconds = 0.0;
+    size_t lastRaggedRowCount = 0;
+
+public:
+    FileHandler();
+    FileHandler(const FileHandler&) = delete;
+    FileHandler& operator=(const FileHandler&) = delete;
+
+public:
+  /**
+    * @brief Open the specified file, read its values and store them in the given matrix.
+    * This file could be selected from the file browser or dropped in. Files in the binary format are recognized by
+    * their signature and loaded without parsing. Any other file is read as comma separated values.
+    * @param filePath The file's path where the floating point values to store are located.
+    * @param targetMatrix A grid to store the file contents. Its number of columns is taken from the first row.
+    * @return false if the file could not be opened, or is a damaged binary file. A binary file whose cells were
+    * changed is only detected with setChecksumVerification().
+    */
+    bool processFile(const std::string& filePath, TemperatureGrid& targetMatrix);
+
+  /**
+    * @brief Write the given matrix to a file, in the binary format if its name ends with BINARY_GRID_EXTENSION and as
+    * comma separated values otherwise. Values are written with the fewest digits that read back as the same number.
+    * @param dataType Type of the cells of a binary file.
+    * @return false if the file could not be written.
+    */
+    bool saveFile(const std::string& filePath, const TemperatureGrid& sourceMatrix, BinaryGridFile::DataType dataType = BinaryGridFile::FLOAT64) const;
+
+  /**
+    * @brief Sets the number of threads that parse a file, or zero for one per hardware thread.
+    */
+    void setThreadCount(int threadCount);
+
+  /**
+    * @brief Makes processFile() check the checksum of binary files before loading them. It reads every cell of the
+    * file up front, instead of only the pages the simulation touches, so it is off by default.
+    */
+    void setChecksumVerification(bool checksumVerification);
+
+  /**
+    * @brief Returns the megabytes per second the last file was read and parsed at, or zero if none was.
+    */
+    double getLastThroughput() const;
+
+  /**
+    * @brief Returns the number of rows of the last file whose number of elements differs from the first row's.
+    * They are padded with zeros or truncated.
+    */
+    size_t getLastRaggedRowCount() const;
+
+private:
+   /**
+    * @brief Parses a file of comma separated values into the given matrix. The file is split in chunks of whole
+    * lines, one per thread. The lines of every chunk are counted first, so each thread knows the first row of its
+    * chunk, and then every chunk is parsed straight into its rows of the matrix at once.
+    * @return The number of ragged rows.
+    */
+    size_t parseText(const MappedFile& file, TemperatureGrid& targetMatrix) const;
+
+   /**
+    * @brief Returns the number of lines between the given bytes, counting a last one without a line break.
+    */
+    static size_t countLines(const char* begin, const char* end);
+
+   /**
+    * @brief Parses the lines between the given bytes into consecutive rows of cells.
+    * @param begin The first byte of the first line.
+    * @param end The byte after the last line.
+    * @param columnCount The number of columns of the matrix.
+    * @param targetMatrix The matrix where the lines are stored.
+    * @param firstRow The row of the matrix of the first line.
+    * @return The number of ragged rows.
+    */
+    static size_t parseRows(const char* begin, const char* end, size_t columnCount, TemperatureGrid& targetMatrix, size_t firstRow);
+
+   /**
+    * @brief Parses the elements of the line that starts at the given byte into a row of cells, padding or truncating
+    * them to the column count.
+    * @param line The first byte of the line, with its elements separated by commas.
+    * @param end The byte after the end of the file.
+    * @param columnCount The number of columns of the matrix.
+    * @param cells The row of the matrix where the elements are stored.
+    * @param ragged Set to whether the line has a different number of elements than the column count.
+    * @return The first byte of the next line.
+    */
+    static const char* parseRow(const char* line, const char* end, size_t columnCount, double* cells, bool& ragged);
+
+   /**
+    * @brief Returns the floating-point value of the given element, or zero if it is not one. Surrounding spaces are
+    * allowed.
+    */
+    static double parseElement(const char* begin, const char* end);
+};
+
+#endif // FILEHANDLER_H
@@ -0,0 +1,85 @@
+#include <thread>
+
+#include "GenerationBarrier.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BARRIER_PAUSE() _mm_pause()
+#else
+#define BARRIER_PAUSE() std::this_thread::yield()
+#endif
+
+GenerationBarrier::GenerationBarrier()
+    : arrivedCount(0)
+    , generation(0)
+    , running(true)
+    , handoffNanoseconds(0)
+    , handoffCount(0)
+    , completionNanoseconds(0)
+    , completionCount(0)
+{}
+
+void GenerationBarrier::reset(int participantCount, std::function<bool()> completion)
+{
+    this->participantCount = participantCount > 0 ? participantCount : 1;
+    this->completion = completion;
+    this->arrivedCount.store(0);
+    this->running.store(true);
+    this->handoffNanoseconds.store(0);
+    this->handoffCount.store(0);
+    this->completionNanoseconds.store(0);
+    this->completionCount.store(0);
+}
+
+bool GenerationBarrier::arriveAndWait()
+{
+    const size_t generation = this->generation.load(std::memory_order_acquire);
+
+    if( this->arrivedCount.fetch_add(1, std::memory_order_acq_rel) + 1 == this->participantCount )
+    {
+        // The completion function is timed apart, so the handoff only measures how long the workers take to wake up.
+        const std::chrono::steady_clock::time_point lastArrival = std::chrono::steady_clock::now();
+        this->running.store( this->completion(), std::memory_order_relaxed );
+        this->completed = std::chrono::steady_clock::now();
+        this->completionNanoseconds.fetch_add( std::chrono::duration_cast<std::chrono::nanoseconds>(this->completed - lastArrival).count(), std::memory_order_relaxed );
+        this->completionCount.fetch_add(1, std::memory_order_relaxed);
+        this->arrivedCount.store(0, std::memory_order_relaxed);
+        {
+            // Publishing under the mutex keeps a worker from missing the notification between its check and its wait.
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->generation.store(generation + 1, std::memory_order_release);
+        }
+        this->released.notify_all();
+    }
+    else
+    {
+        bool releasedWhileSpinning = false;
+        for( int spin = 0; spin < BARRIER_SPIN_COUNT && !releasedWhileSpinning; ++spin )
+        {
+            BARRIER_PAUSE();
+            releasedWhileSpinning = this->generation.load(std::memory_order_acquire) != generation;
+        }
+        if( !releasedWhileSpinning )
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->released.wait( lock, [this, generation]() { return this->generation.load(std::memory_order_acquire) != generation; } );
+        }
+    }
+
+    const std::chrono::steady_clock::duration handoff = std::chrono::steady_clock::now() - this->completed;
+    this->handoffNanoseconds.fetch_add( std::chrono::duration_cast<std::chrono::nanoseconds>(handoff).count(), std::memory_order_relaxed );
+    this->handoffCount.fetch_add(1, std::memory_order_relaxed);
+    return this->running.load(std::memory_order_relaxed);
+}
+
+double GenerationBarrier::getAverageHandoffSeconds() const
+{
+    const long long count = this->handoffCount.load();
+    return count > 0 ? this->handoffNanoseconds.load() / 1e9 / count : 0.0;
+}
+
+double GenerationBarrier::getAverageCompletionSeconds() const
+{
+    const long long count = this->completionCount.load();
+    return count > 0 ? this->completionNanoseconds.load() / 1e9 / count : 0.0;
+}
@@ -0,0 +1,69 @@
+#ifndef GENERATIONBARRIER_H
+#define GENERATIONBARRIER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+// Times a waiting worker polls the barrier before blocking on the condition variable.
+#define BARRIER_SPIN_COUNT 4000
+
+/**
+ * Meeting point of the worker pool between two phases of a simulation. The last worker to arrive runs the
+ * completion function on its own thread while the others wait, so the bookkeeping of a generation needs no
+ * locks and no event loop. Waiting workers spin for a while first, since on small matrices the next phase
+ * usually starts sooner than a thread could be woken up, and then block so they do not steal the processor
+ * from workers that are still sweeping their rows.
+ */
+class GenerationBarrier
+{
+private:
+    int participantCount = 1;
+    std::function<bool()> completion;
+
+    std::atomic<int> arrivedCount;
+    std::atomic<size_t> generation;
+    std::atomic<bool> running;
+
+    std::mutex mutex;
+    std::condition_variable released;
+
+    // Time the completion function returned, which the handoff is measured from.
+    std::chrono::steady_clock::time_point completed;
+    std::atomic<long long> handoffNanoseconds;
+    std::atomic<long long> handoffCount;
+    std::atomic<long long> completionNanoseconds;
+    std::atomic<long long> completionCount;
+
+public:
+    GenerationBarrier();
+
+    /**
+     * @brief Prepares the barrier for a new pool. It must not be called while workers are waiting on it.
+     * @param participantCount Number of workers that call arriveAndWait() on every phase.
+     * @param completion Function run by the last worker to arrive. Returning false stops the pool.
+     */
+    void reset(int participantCount, std::function<bool()> completion);
+
+    /**
+     * @brief Waits until every participant arrived and the completion function was run.
+     * @return The value returned by the completion function, false when the workers must leave their loop.
+     */
+    bool arriveAndWait();
+
+    /**
+     * @brief Returns the average seconds between the completion function returning and a worker starting the next
+     * phase, the cost of the barrier itself.
+     */
+    double getAverageHandoffSeconds() const;
+
+    /**
+     * @brief Returns the average seconds the completion function took, while every worker waited for it.
+     */
+    double getAverageCompletionSeconds() const;
+};
+
+#endif // GENERATIONBARRIER_H
@@ -0,0 +1,161 @@
+#include <chrono>
+#include <cstring>
+
+#include "HaloExchange.h"
+#include "HeatMapWorker.h"
+#include "TemperatureGrid.h"
+#include "Transport.h"
+
+HaloExchange::HaloExchange(Transport * transport)
+    : transport(transport)
+{
+}
+
+bool HaloExchange::setup(size_t rowCount, size_t columnCount, TileScheduler::Decomposition decomposition)
+{
+    this->rowCount = rowCount;
+    this->columnCount = columnCount;
+    this->communicationSeconds = 0.0;
+
+    // The processes are laid out like the workers of the pool, so their blocks are the same.
+    const int processCount = this->transport->getProcessCount();
+    const int rank = this->transport->getRank();
+    const size_t interiorRows = rowCount > 2 ? rowCount - 2 : 0;
+    const size_t interiorColumns = columnCount > 2 ? columnCount - 2 : 0;
+    this->gridRows = processCount;
+    this->gridColumns = 1;
+    if( decomposition == TileScheduler::BLOCKS )
+        TileScheduler::chooseGrid(interiorRows, interiorColumns, processCount, this->gridRows, this->gridColumns);
+    if( static_cast<size_t>(this->gridRows) > interiorRows || static_cast<size_t>(this->gridColumns) > interiorColumns )
+        return false;
+
+    const int blockRow = rank / this->gridColumns;
+    const int blockColumn = rank % this->gridColumns;
+    this->block.startRow = HeatMapWorker::calculateStart(interiorRows, this->gridRows, blockRow);
+    this->block.finishRow = HeatMapWorker::calculateFinish(interiorRows, this->gridRows, blockRow);
+    this->block.startColumn = HeatMapWorker::calculateStart(interiorColumns, this->gridColumns, blockColumn);
+    this->block.finishColumn = HeatMapWorker::calculateFinish(interiorColumns, this->gridColumns, blockColumn);
+    this->above = blockRow > 0 ? rank - this->gridColumns : -1;
+    this->below = rank + this->gridColumns < processCount ? rank + this->gridColumns : -1;
+    this->left = blockColumn > 0 ? rank - 1 : -1;
+    this->right = blockColumn + 1 < this->gridColumns ? rank + 1 : -1;
+
+    const size_t blockRows = this->block.finishRow - this->block.startRow;
+    this->sentColumn.assign(blockRows, 0.0);
+    this->receivedColumn.assign(blockRows, 0.0);
+    return true;
+}
+
+const TileScheduler::Tile& HaloExchange::getBlock() const
+{
+    return this->block;
+}
+
+void HaloExchange::extractBlock(const TemperatureGrid& matrix, TemperatureGrid& blockMatrix) const
+{
+    // The interior coordinates of the block are the full coordinates of its halo.
+    const size_t blockRows = this->block.finishRow - this->block.startRow + 2;
+    const size_t blockColumns = this->block.finishColumn - this->block.startColumn + 2;
+    blockMatrix.resize(blockRows, blockColumns);
+    for( size_t row = 0; row < blockRows; ++row )
+        std::memcpy( blockMatrix.row(row), matrix.row(this->block.startRow + row) + this->block.startColumn, blockColumns * sizeof(double) );
+}
+
+bool HaloExchange::exchange(TemperatureGrid& blockMatrix, double maximumDelta, double& globalDelta)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    globalDelta = maximumDelta;
+    // The corners of the halo are never read by the stencil, so the rows and the columns are exchanged on their own.
+    const bool exchanged = this->exchangeRows(blockMatrix) && this->exchangeColumns(blockMatrix)
+            && this->transport->allReduceMaximum(globalDelta);
+    this->communicationSeconds += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    return exchanged;
+}
+
+bool HaloExchange::gather(const TemperatureGrid& blockMatrix, TemperatureGrid& matrix)
+{
+    const int rank = this->transport->getRank();
+    const size_t blockRows = this->block.finishRow - this->block.startRow;
+    const size_t blockColumns = this->block.finishColumn - this->block.startColumn;
+    if( rank != 0 )
+    {
+        for( size_t row = 0; row < blockRows; ++row )
+            if( !this->transport->send(0, blockMatrix.interior(row), blockColumns * sizeof(double)) )
+                return false;
+        return true;
+    }
+
+    // Every block is received straight into its rows of the whole matrix.
+    const size_t interiorRows = this->rowCount - 2;
+    const size_t interiorColumns = this->columnCount - 2;
+    for( size_t row = 0; row < blockRows; ++row )
+        std::memcpy( matrix.interior(this->block.startRow + row) + this->block.startColumn, blockMatrix.interior(row), blockColumns * sizeof(double) );
+    for( int peer = 1; peer < this->transport->getProcessCount(); ++peer )
+    {
+        const int blockRow = peer / this->gridColumns;
+        const int blockColumn = peer % this->gridColumns;
+        const size_t startRow = HeatMapWorker::calculateStart(interiorRows, this->gridRows, blockRow);
+        const size_t finishRow = HeatMapWorker::calculateFinish(interiorRows, this->gridRows, blockRow);
+        const size_t startColumn = HeatMapWorker::calculateStart(interiorColumns, this->gridColumns, blockColumn);
+        const size_t finishColumn = HeatMapWorker::calculateFinish(interiorColumns, this->gridColumns, blockColumn);
+        for( size_t row = startRow; row < finishRow; ++row )
+            if( !this->transport->receive(peer, matrix.interior(row) + startColumn, (finishColumn - startColumn) * sizeof(double)) )
+                return false;
+    }
+    return true;
+}
+
+double HaloExchange::getCommunicationSeconds() const
+{
+    return this->communicationSeconds;
+}
+
+bool HaloExchange::exchangeRows(TemperatureGrid& blockMatrix)
+{
+    // Even block rows exchange with the one below first and odd ones with the one above, so the pairs of
+    // neighbours meet at once instead of waiting for each other from the top of the matrix to the bottom.
+    const size_t blockRows = this->block.finishRow - this->block.startRow;
+    const size_t bytes = (this->block.finishColumn - this->block.startColumn) * sizeof(double);
+    const bool belowFirst = (this->transport->getRank() / this->gridColumns) % 2 == 0;
+    for( int step = 0; step < 2; ++step )
+    {
+        if( (step == 0) == belowFirst )
+        {
+            if( this->below >= 0 && !this->transport->exchange(this->below, blockMatrix.interior(blockRows - 1), blockMatrix.row(blockRows + 1) + 1, bytes) )
+                return false;
+        }
+        else if( this->above >= 0 && !this->transport->exchange(this->above, blockMatrix.interior(0), blockMatrix.row(0) + 1, bytes) )
+            return false;
+    }
+    return true;
+}
+
+bool HaloExchange::exchangeColumns(TemperatureGrid& blockMatrix)
+{
+    const size_t blockColumns = this->block.finishColumn - this->block.startColumn;
+    const bool rightFirst = (this->transport->getRank() % this->gridColumns) % 2 == 0;
+    for( int step = 0; step < 2; ++step )
+    {
+        if( (step == 0) == rightFirst )
+        {
+            if( this->right >= 0 && !this->exchangeColumn(blockMatrix, this->right, blockColumns, blockColumns + 1) )
+                return false;
+        }
+        else if( this->left >= 0 && !this->exchangeColumn(blockMatrix, this->left, 1, 0) )
+            return false;
+    }
+    return true;
+}
+
+bool HaloExchange::exchangeColumn(TemperatureGrid& blockMatrix, int peer, size_t edgeColumn, size_t haloColumn)
+{
+    // Columns are not contiguous, so they go through a buffer.
+    const size_t blockRows = this->sentColumn.size();
+    for( size_t row = 0; row < blockRows; ++row )
+        this->sentColumn[row] = blockMatrix(row + 1, edgeColumn);
+    if( !this->transport->exchange(peer, this->sentColumn.data(), this->receivedColumn.data(), blockRows * sizeof(double)) )
+        return false;
+    for( size_t row = 0; row < blockRows; ++row )
+        blockMatrix(row + 1, haloColumn) = this->receivedColumn[row];
+    return true;
+}
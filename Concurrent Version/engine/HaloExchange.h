@@ -0,0 +1,99 @@
+#ifndef HALOEXCHANGE_H
+#define HALOEXCHANGE_H
+
+#include <cstddef>
+#include <vector>
+
+#include "TileScheduler.h"
+
+class TemperatureGrid;
+class Transport;
+
+/**
+ * Splits a matrix among the processes of a distributed simulation the same way the pool splits it among its
+ * workers, and keeps the block of this process in step with its neighbours. Every process simulates its block as a
+ * matrix of its own, whose border is the halo: the border of the whole matrix where the block touches it, and the
+ * edge rows and columns of the neighbouring blocks elsewhere. After every generation the processes exchange the
+ * new edges of their blocks into the halo of the others, and agree on the largest change of any cell, so they all
+ * reach the equilibrium state on the same generation as a single process would.
+ */
+class HaloExchange
+{
+private:
+    Transport * transport = nullptr;
+    int gridRows = 1;
+    int gridColumns = 1;
+    size_t rowCount = 0;
+    size_t columnCount = 0;
+    // Interior rectangle of the whole matrix that this process simulates.
+    TileScheduler::Tile block = {0, 0, 0, 0};
+    // Ranks of the processes of the neighbouring blocks, or -1 where the block touches the border of the matrix.
+    int above = -1;
+    int below = -1;
+    int left = -1;
+    int right = -1;
+    std::vector<double> sentColumn;
+    std::vector<double> receivedColumn;
+    double communicationSeconds = 0.0;
+
+public:
+    explicit HaloExchange(Transport * transport);
+
+    /**
+     * @brief Splits the interior of a matrix of the given size in one block per process.
+     * @return false if some process would get no cell.
+     */
+    bool setup(size_t rowCount, size_t columnCount, TileScheduler::Decomposition decomposition);
+
+    /**
+     * @brief Returns the interior rectangle of the whole matrix that this process simulates.
+     */
+    const TileScheduler::Tile& getBlock() const;
+
+    /**
+     * @brief Copies the block of this process out of the whole matrix, together with its halo.
+     */
+    void extractBlock(const TemperatureGrid& matrix, TemperatureGrid& blockMatrix) const;
+
+    /**
+     * @brief Sends the edges of the block to the neighbours, stores theirs in the halo, and finds the largest
+     * change of a cell in the last generation among every process. Every process must call it once per generation.
+     * @param blockMatrix The newest generation of the block of this process.
+     * @param maximumDelta Largest change of a cell of the block in the last generation.
+     * @param globalDelta Receives the largest change of a cell of the whole matrix.
+     * @return false if a process could not be reached.
+     */
+    bool exchange(TemperatureGrid& blockMatrix, double maximumDelta, double& globalDelta);
+
+    /**
+     * @brief Collects the blocks of every process in the first one. Every process must call it.
+     * @param blockMatrix The block of this process.
+     * @param matrix The whole matrix, only used by the first process, where the blocks are copied into.
+     * @return false if a process could not be reached.
+     */
+    bool gather(const TemperatureGrid& blockMatrix, TemperatureGrid& matrix);
+
+    /**
+     * @brief Returns the seconds spent exchanging halos and waiting for the other processes since setup().
+     */
+    double getCommunicationSeconds() const;
+
+private:
+    /**
+     * @brief Exchanges the edge rows of the block with the neighbours above and below.
+     */
+    bool exchangeRows(TemperatureGrid& blockMatrix);
+
+    /**
+     * @brief Exchanges the edge columns of the block with the neighbours on the left and on the right.
+     */
+    bool exchangeColumns(TemperatureGrid& blockMatrix);
+
+    /**
+     * @brief Exchanges the given edge column of the block with the neighbour, and stores its edge in the halo column.
+     * Both are columns of the block matrix, halo included.
+     */
+    bool exchangeColumn(TemperatureGrid& blockMatrix, int peer, size_t edgeColumn, size_t haloColumn);
+};
+
+#endif // HALOEXCHANGE_H
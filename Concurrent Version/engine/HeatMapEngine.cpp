@@ -0,0 +1,771 @@
+#include <algorithm>
+#include <thread>
+
+#include "AsynchronousRelaxation.h"
+#include "CancellationToken.h"
+#include "CheckpointWriter.h"
+#include "FastPoissonSolver.h"
+#include "FileHandler.h"
+#include "GenerationBarrier.h"
+#include "HaloExchange.h"
+#include "HeatMapEngine.h"
+#include "HeatMapWorker.h"
+#include "RelaxationEstimator.h"
+#include "TemperatureGrid.h"
+#include "TileScheduler.h"
+
+HeatMapEngine::HeatMapEngine()
+{
+    this->fileHandler = new FileHandler();
+    this->relaxationEstimator = new RelaxationEstimator();
+    this->multigridSolver = new MultigridSolver();
+    this->fastPoissonSolver = new FastPoissonSolver();
+    this->conjugateGradientSolver = new ConjugateGradientSolver();
+    this->asynchronousRelaxation = new AsynchronousRelaxation();
+    this->generationBarrier = new GenerationBarrier();
+    this->tileScheduler = new TileScheduler();
+    this->snapshotBuffer = new SnapshotBuffer();
+    this->cancellationToken = new CancellationToken();
+    this->checkpointWriter = new CheckpointWriter();
+    this->previousTemperatureMatrix = new TemperatureGrid();
+    this->placementMatrix = new TemperatureGrid();
+    this->currentTemperatureMatrix = new TemperatureGrid();
+}
+
+HeatMapEngine::~HeatMapEngine()
+{
+    delete this->previousTemperatureMatrix;
+    delete this->placementMatrix;
+    delete this->currentTemperatureMatrix;
+    delete this->checkpointWriter;
+    delete this->cancellationToken;
+    delete this->snapshotBuffer;
+    delete this->tileScheduler;
+    delete this->generationBarrier;
+    delete this->asynchronousRelaxation;
+    delete this->conjugateGradientSolver;
+    delete this->fastPoissonSolver;
+    delete this->multigridSolver;
+    delete this->relaxationEstimator;
+    delete this->fileHandler;
+}
+
+bool HeatMapEngine::loadFile(const std::string& filePath)
+{
+    if( !this->previousTemperatureMatrix->empty() )
+        this->previousTemperatureMatrix->clear();
+    const bool loaded = this->fileHandler->processFile(filePath, *this->previousTemperatureMatrix);
+    this->loadMatrix(*this->previousTemperatureMatrix);
+    return loaded;
+}
+
+double HeatMapEngine::getLoadThroughput() const
+{
+    return this->fileHandler->getLastThroughput();
+}
+
+size_t HeatMapEngine::getRaggedRowCount() const
+{
+    return this->fileHandler->getLastRaggedRowCount();
+}
+
+void HeatMapEngine::loadMatrix(const TemperatureGrid& matrix)
+{
+    this->previousTemperatureMatrix->assign(matrix);
+    this->currentTemperatureMatrix->assign(*this->previousTemperatureMatrix);
+    this->simulationStarted = false;
+    this->equilibriumState = false;
+    this->generationCompleted = true;
+    this->generationCount = 0;
+    this->startGeneration = 0;
+    this->startSeconds = 0.0;
+    // A stop of the last simulation has nothing to do with the new one.
+    this->cancellationToken->reset();
+    this->publishSnapshot(true);
+}
+
+bool HeatMapEngine::loadCheckpoint(const std::string& filePath)
+{
+    TemperatureGrid matrix;
+    CheckpointWriter::State state;
+    if( !CheckpointWriter::read(filePath, matrix, state) )
+        return false;
+
+    this->setSolver(state.solver);
+    this->setEpsilon(state.epsilon);
+    if( state.solver == SOR_SOLVER )
+    {
+        this->setRelaxationFactor(state.relaxationFactor);
+        this->setAdaptiveRelaxation(false);
+    }
+    this->loadMatrix(matrix);
+    this->generationCount = this->startGeneration = state.generationCount;
+    this->solveSeconds = this->startSeconds = state.solveSeconds;
+    this->publishSnapshot(true);
+    return true;
+}
+
+void HeatMapEngine::setCheckpointing(const std::string& filePath, double intervalSeconds)
+{
+    this->checkpointPath = filePath;
+    this->checkpointInterval = intervalSeconds;
+    this->lastCheckpoint = std::chrono::steady_clock::now();
+}
+
+bool HeatMapEngine::saveCheckpoint()
+{
+    if( this->checkpointPath.empty() || !this->isCheckpointable() )
+        return false;
+    this->checkpointWriter->wait();
+    if( !this->generationCompleted )
+        return false;
+    this->checkpointWriter->getMatrix().assign( this->getResult() );
+    this->checkpointWriter->submit( this->checkpointPath, this->getCheckpointState() );
+    this->lastCheckpoint = std::chrono::steady_clock::now();
+    return this->checkpointWriter->wait();
+}
+
+size_t HeatMapEngine::getCheckpointGeneration() const
+{
+    return this->checkpointWriter->getWrittenGeneration();
+}
+
+bool HeatMapEngine::run()
+{
+    this->generationLimit = 0;
+    return this->simulateHeatExchange();
+}
+
+bool HeatMapEngine::step(size_t generations)
+{
+    if( generations == 0 )
+        return this->equilibriumState;
+    this->generationLimit = (this->simulationStarted ? this->generationCount : this->startGeneration) + generations;
+    return this->simulateHeatExchange();
+}
+
+void HeatMapEngine::stop()
+{
+    // The workers check for it between bands of rows, the multigrid solver between cycles, and run() joins the
+    // workers once they leave. The token drops it when no run is in flight.
+    this->cancellationToken->request();
+}
+
+double HeatMapEngine::getStopLatency() const
+{
+    return this->stopLatency;
+}
+
+const TemperatureGrid& HeatMapEngine::getResult() const
+{
+    // Jacobi leaves the last generation in the current matrix, the in-place solvers in the only one they use.
+    if( isInPlaceSolver(this->solver) || this->currentTemperatureMatrix->empty() )
+        return *this->previousTemperatureMatrix;
+    return *this->currentTemperatureMatrix;
+}
+
+size_t HeatMapEngine::getNumberOfRows() const
+{
+     return this->previousTemperatureMatrix->getNumberOfRows();
+}
+
+size_t HeatMapEngine::getNumberOfColumns() const
+{
+     return this->previousTemperatureMatrix->getNumberOfColumns();
+}
+
+void HeatMapEngine::setEpsilon(double epsilon)
+{
+    this->epsilon = epsilon;
+}
+
+double HeatMapEngine::getEpsilon() const
+{
+    return this->epsilon;
+}
+
+void HeatMapEngine::setThreadCount(int threadCount)
+{
+    this->threadCount = std::max(threadCount, 0);
+}
+
+int HeatMapEngine::getThreadCount() const
+{
+    return this->threadCount;
+}
+
+void HeatMapEngine::setTileShape(size_t tileHeight, size_t tileWidth)
+{
+    this->tileHeight = tileHeight;
+    this->tileWidth = tileWidth;
+}
+
+size_t HeatMapEngine::getTileHeight() const
+{
+    return this->tileHeight;
+}
+
+size_t HeatMapEngine::getTileWidth() const
+{
+    return this->tileWidth;
+}
+
+void HeatMapEngine::setTemporalBlocking(size_t generationsPerPass)
+{
+    this->generationsPerPass = std::max(generationsPerPass, static_cast<size_t>(1));
+}
+
+bool HeatMapEngine::setKernelVariant(StencilKernel::Variant kernelVariant)
+{
+    if( !StencilKernel::isSupported(kernelVariant) )
+        return false;
+    this->kernelVariant = kernelVariant;
+    return true;
+}
+
+StencilKernel::Variant HeatMapEngine::getKernelVariant() const
+{
+    return this->kernelVariant;
+}
+
+void HeatMapEngine::setWorkStealing(bool workStealing)
+{
+    this->workStealing = workStealing;
+}
+
+void HeatMapEngine::setDecomposition(TileScheduler::Decomposition decomposition)
+{
+    this->decomposition = decomposition;
+}
+
+void HeatMapEngine::setMemoryPlacement(NumaTopology::Placement memoryPlacement)
+{
+    this->memoryPlacement = memoryPlacement;
+}
+
+void HeatMapEngine::setCpuAffinity(const std::vector<int>& cpuAffinity)
+{
+    this->cpuAffinity = cpuAffinity;
+}
+
+void HeatMapEngine::setSolver(Solver solver)
+{
+    // Selecting the same solver again resumes a stopped simulation.
+    if( solver != this->solver )
+        this->simulationStarted = false;
+    this->solver = solver;
+}
+
+Solver HeatMapEngine::getSolver() const
+{
+    return this->solver;
+}
+
+void HeatMapEngine::setRelaxationFactor(double relaxationFactor)
+{
+    this->relaxationFactor = relaxationFactor;
+    this->simulationStarted = false;
+}
+
+void HeatMapEngine::setAdaptiveRelaxation(bool adaptiveRelaxation)
+{
+    this->adaptiveRelaxation = adaptiveRelaxation;
+    this->simulationStarted = false;
+}
+
+double HeatMapEngine::getRelaxationFactor() const
+{
+    return this->relaxationEstimator->getRelaxationFactor();
+}
+
+void HeatMapEngine::setMultigridCycle(MultigridSolver::Cycle cycle)
+{
+    this->multigridCycle = cycle;
+    this->simulationStarted = false;
+}
+
+void HeatMapEngine::setPreconditioner(ConjugateGradientSolver::Preconditioner preconditioner)
+{
+    this->preconditioner = preconditioner;
+    this->simulationStarted = false;
+}
+
+void HeatMapEngine::setHaloExchange(HaloExchange * haloExchange)
+{
+    this->haloExchange = haloExchange;
+    this->simulationStarted = false;
+}
+
+size_t HeatMapEngine::getGenerationCount() const
+{
+    return this->generationCount;
+}
+
+double HeatMapEngine::getResidualNorm() const
+{
+    return this->conjugateGradientSolver->getResidualNorm();
+}
+
+double HeatMapEngine::getHandoffLatency() const
+{
+    return this->generationBarrier->getAverageHandoffSeconds();
+}
+
+double HeatMapEngine::getPhaseCompletionTime() const
+{
+    return this->generationBarrier->getAverageCompletionSeconds();
+}
+
+std::vector<long long> HeatMapEngine::getStolenTileCounts() const
+{
+    return this->tileScheduler->getStolenTileCounts();
+}
+
+std::vector<double> HeatMapEngine::getIdleSeconds() const
+{
+    return this->tileScheduler->getIdleSeconds();
+}
+
+std::vector<int> HeatMapEngine::getWorkerCpus() const
+{
+    return this->workerCpus;
+}
+
+std::vector< std::vector<size_t> > HeatMapEngine::getPartitionPages() const
+{
+    return this->partitionPages;
+}
+
+const SnapshotBuffer::Snapshot& HeatMapEngine::acquireSnapshot()
+{
+    return this->snapshotBuffer->acquire();
+}
+
+double HeatMapEngine::getSolveSeconds() const
+{
+    return this->solveSeconds;
+}
+
+bool HeatMapEngine::simulateHeatExchange()
+{
+    if( this->haloExchange != nullptr && this->solver != JACOBI_SOLVER )
+    {
+        this->equilibriumState = false;
+        return false;
+    }
+    // Only the stops requested while this run is in flight count.
+    this->cancellationToken->begin();
+    this->stopped = false;
+    this->stopLatency = 0.0;
+    if( !this->simulationStarted )
+        this->startSimulation();
+    this->equilibriumState = true;
+    this->solveStart = std::chrono::steady_clock::now();
+
+    if( this->solver == MULTIGRID_SOLVER )
+        this->solveMultigrid();
+    else if( this->solver == DIRECT_SOLVER )
+        this->solveDirect();
+    else
+        this->runPool();
+
+    this->cancellationToken->end();
+    this->solveSeconds += std::chrono::duration<double>( std::chrono::steady_clock::now() - this->solveStart ).count();
+    // A stop that came once the solver finished by itself leaves its result complete.
+    this->generationCompleted = !this->stopped || !isInPlaceSolver(this->solver);
+    if( this->stopped )
+    {
+        this->stopLatency = this->cancellationToken->getSecondsSinceRequest();
+        this->equilibriumState = false;
+        // The vectors of an iteration cut half way do not match the matrix any more.
+        if( this->solver == CONJUGATE_GRADIENT_SOLVER )
+            this->conjugateGradientSolver->restart();
+    }
+    return this->equilibriumState;
+}
+
+void HeatMapEngine::startSimulation()
+{
+    this->simulationStarted = true;
+    this->finishedPhaseCount = 0;
+    // A loaded checkpoint only sets the counters of the simulation that starts from it.
+    this->generationCount = this->startGeneration;
+    this->generationDelta = 0.0;
+    this->solveSeconds = this->startSeconds;
+    this->startGeneration = 0;
+    this->startSeconds = 0.0;
+
+    // The last generation is in the current matrix, unless an in-place solver released it. The in-place solvers
+    // update the other one, and Jacobi needs both to start from it.
+    if( !this->currentTemperatureMatrix->empty() )
+        this->previousTemperatureMatrix->swap(*this->currentTemperatureMatrix);
+    if( isInPlaceSolver(this->solver) )
+        this->currentTemperatureMatrix->clear();
+    else
+        this->currentTemperatureMatrix->assign(*this->previousTemperatureMatrix);
+
+    if( this->solver == SOR_SOLVER )
+    {
+        double factor = this->relaxationFactor;
+        if( factor <= 0.0 )
+            factor = RelaxationEstimator::getOptimalFactor( this->previousTemperatureMatrix->getInteriorRows(), this->previousTemperatureMatrix->getInteriorColumns() );
+        this->relaxationEstimator->reset( this->adaptiveRelaxation ? 1.0 : factor, factor );
+    }
+    else
+        this->relaxationEstimator->reset(1.0, 1.0);
+
+    if( this->solver == MULTIGRID_SOLVER )
+        this->multigridSolver->setup(this->previousTemperatureMatrix, this->multigridCycle);
+
+    // The loaded pages are all where the loading thread put them, so the matrices are copied into fresh ones that
+    // every worker writes first, or that are spread over the nodes. Only the pool has workers to place them, and
+    // the asynchronous workers sweep private copies of their blocks that they write first anyway.
+    this->workerCpus.clear();
+    this->partitionPages.clear();
+    this->placementPending = this->memoryPlacement != NumaTopology::LOADER_PLACEMENT && this->solver != MULTIGRID_SOLVER && this->solver != DIRECT_SOLVER
+            && this->solver != ASYNCHRONOUS_SOLVER;
+    if( this->placementPending )
+    {
+        const bool interleaved = this->memoryPlacement == NumaTopology::INTERLEAVED_PLACEMENT;
+        this->placementMatrix->swap(*this->previousTemperatureMatrix);
+        this->previousTemperatureMatrix->reshape( this->placementMatrix->getNumberOfRows(), this->placementMatrix->getNumberOfColumns(), interleaved );
+        if( !isInPlaceSolver(this->solver) )
+            this->currentTemperatureMatrix->reshape( this->placementMatrix->getNumberOfRows(), this->placementMatrix->getNumberOfColumns(), interleaved );
+    }
+    // Its initial residual needs the whole matrix, so with a placement it is calculated once the workers copied it.
+    else if( this->solver == CONJUGATE_GRADIENT_SOLVER )
+        this->conjugateGradientSolver->setup(this->previousTemperatureMatrix, this->preconditioner, 1);
+}
+
+void HeatMapEngine::runPool()
+{
+    this->workers.clear();
+    // New workers start a red-black generation from its red cells, even if a stop cut the last one after them.
+    this->finishedPhaseCount = 0;
+
+    // Stripes need a row per worker, blocks only a cell.
+    const size_t interiorRows = this->previousTemperatureMatrix->getInteriorRows();
+    const size_t interiorColumns = this->previousTemperatureMatrix->getInteriorColumns();
+    const size_t maximumWorkers = this->decomposition == TileScheduler::BLOCKS ? interiorRows * interiorColumns : interiorRows;
+    const size_t requestedWorkers = this->threadCount > 0 ? static_cast<size_t>(this->threadCount) : static_cast<size_t>(std::thread::hardware_concurrency());
+    int workerCount = static_cast<int>( std::max( std::min( requestedWorkers, maximumWorkers ), static_cast<size_t>(1) ) );
+
+    // The tiles of the scheduler are whole cache tiles of the workers, so their sweeps do not change.
+    size_t cacheTileRows = this->tileHeight;
+    if( cacheTileRows == 0 && this->getGenerationsPerPass() > 1 && this->solver == JACOBI_SOLVER )
+        cacheTileRows = TEMPORAL_TILE_HEIGHT;
+    // The asynchronous workers keep the blocks of their own tiles, since they never meet to deal them again.
+    const bool asynchronous = this->solver == ASYNCHRONOUS_SOLVER;
+    this->tileScheduler->setup(interiorRows, interiorColumns, workerCount, cacheTileRows, this->decomposition, this->workStealing && !asynchronous);
+    if( asynchronous )
+        this->asynchronousRelaxation->setup( this->previousTemperatureMatrix, *this->tileScheduler, this->epsilon
+                                           , this->generationLimit > 0 ? this->generationLimit - this->generationCount : 0 );
+    // Every phase ends with all the partial sums added up, so the tiles may change between calls.
+    if( this->solver == CONJUGATE_GRADIENT_SOLVER )
+        this->conjugateGradientSolver->setSlotCount( this->tileScheduler->getTileCount() );
+
+    this->generationBarrier->reset( workerCount, [this]() { return this->completePhase(); } );
+    for( int workerId = 0; workerId < workerCount; ++workerId )
+    {
+        HeatMapWorker* worker = new HeatMapWorker{workerId, workerCount, this->epsilon, this->previousTemperatureMatrix, this->currentTemperatureMatrix, this->tileHeight, this->tileWidth, this->getGenerationsPerPass(), this->solver};
+        worker->setRelaxationFactor( this->relaxationEstimator->getRelaxationFactor() );
+        worker->setKernelVariant(this->kernelVariant);
+        worker->setConjugateGradientSolver(this->conjugateGradientSolver);
+        worker->setAsynchronousRelaxation(this->asynchronousRelaxation);
+        worker->setGenerationBarrier(this->generationBarrier);
+        worker->setTileScheduler(this->tileScheduler);
+        worker->setCancellationToken(this->cancellationToken);
+        if( !this->cpuAffinity.empty() )
+            worker->setCpu( this->cpuAffinity[workerId % this->cpuAffinity.size()] );
+        if( this->placementPending )
+            worker->setPlacementSource(this->placementMatrix);
+        this->workers.push_back(worker);
+    }
+    for ( HeatMapWorker* worker : this->workers )
+        worker->start();
+
+    // The pool runs every generation by itself, the engine only waits for it to stop.
+    for ( HeatMapWorker* worker : this->workers )
+    {
+        worker->wait();
+        delete worker;
+    }
+    this->workers.clear();
+    if( asynchronous )
+    {
+        // The blocks sweep at their own pace, so a generation is the average sweep of a worker.
+        this->generationCount += this->asynchronousRelaxation->getAverageSweepCount();
+        this->equilibriumState = this->asynchronousRelaxation->isFinished();
+        this->stopped = !this->equilibriumState && this->cancellationToken->isRequested();
+    }
+    this->publishSnapshot(true);
+}
+
+void HeatMapEngine::solveMultigrid()
+{
+    while( true )
+    {
+        if( this->cancellationToken->isRequested() )
+        {
+            this->stopped = true;
+            break;
+        }
+        const double maximumDelta = this->multigridSolver->iterate();
+        this->generationCount = this->multigridSolver->getCycleCount();
+        if( maximumDelta <= this->epsilon )
+            break;
+        if( this->isGenerationLimitReached() )
+        {
+            this->equilibriumState = false;
+            break;
+        }
+        this->publishSnapshot(false);
+    }
+    this->publishSnapshot(true);
+}
+
+void HeatMapEngine::solveDirect()
+{
+    // It never checks the token, so a stop requested meanwhile leaves its result complete.
+    this->fastPoissonSolver->solve(*this->previousTemperatureMatrix);
+    this->publishSnapshot(true);
+}
+
+bool HeatMapEngine::isGenerationLimitReached() const
+{
+    return this->generationLimit > 0 && this->generationCount >= this->generationLimit;
+}
+
+size_t HeatMapEngine::getGenerationsPerPass() const
+{
+    // The halo only holds one line of each neighbour, which is enough for a single generation.
+    return this->haloExchange != nullptr ? 1 : this->generationsPerPass;
+}
+
+bool HeatMapEngine::completePhase()
+{
+    // The placement is finished even when the simulation is stopped, so the matrix is never left half copied.
+    if( this->placementPending )
+    {
+        this->finishPlacement();
+        this->recordPlacement();
+        this->stopped = this->cancellationToken->isRequested();
+        return !this->stopped;
+    }
+    if( this->snapshotPending )
+        this->finishSnapshot();
+    if( this->checkpointPending )
+        this->finishCheckpoint();
+    if( this->cancellationToken->isRequested() )
+    {
+        this->stopped = true;
+        return false;
+    }
+
+    // Every tile was taken, so they can be dealt again for the next phase.
+    this->tileScheduler->reset();
+    if( this->partitionPages.empty() )
+        this->recordPlacement();
+
+    for ( HeatMapWorker* worker : this->workers )
+    {
+        this->generationDelta = std::max( this->generationDelta, worker->getMaximumDelta() );
+        if( worker->getMaximumDelta() > this->epsilon )
+            this->equilibriumState = false;
+    }
+
+    if( this->solver == CONJUGATE_GRADIENT_SOLVER )
+    {
+        // An iteration has several phases, and its residual is only known once the last one is added up.
+        if( !this->conjugateGradientSolver->finishPhase() )
+            return true;
+        this->generationCount = this->conjugateGradientSolver->getIterationCount();
+        this->equilibriumState = this->conjugateGradientSolver->getMaximumDelta() <= this->epsilon;
+    }
+    else if( isRedBlackSolver(this->solver) )
+    {
+        // A red-black generation has two phases, the black cells can only be updated once all the red ones are.
+        if( ++this->finishedPhaseCount < 2 )
+            return true;
+        this->finishedPhaseCount = 0;
+        ++this->generationCount;
+    }
+    else
+    {
+        this->generationCount += this->getGenerationsPerPass();
+        TemperatureGrid* temp = this->previousTemperatureMatrix;
+        this->previousTemperatureMatrix = this->currentTemperatureMatrix;
+        this->currentTemperatureMatrix = temp;
+
+        // The next generation reads the edges of the neighbours from the halo, and every process must stop on the
+        // same generation, so they all decide it from the largest change of the whole matrix.
+        if( this->haloExchange != nullptr )
+        {
+            double globalDelta = 0.0;
+            if( !this->haloExchange->exchange(*this->currentTemperatureMatrix, this->generationDelta, globalDelta) )
+            {
+                // A process is gone, so the others cannot go on either.
+                this->cancellationToken->request();
+                this->stopped = true;
+                return false;
+            }
+            this->equilibriumState = globalDelta <= this->epsilon;
+        }
+    }
+
+    if( this->getEquilibriumState() )
+        return false;
+    if( this->isGenerationLimitReached() )
+    {
+        this->equilibriumState = false;
+        return false;
+    }
+    // Only scheduled when a phase follows, since the workers copy them during that phase. The last generation is
+    // published anyway once the pool stops.
+    this->scheduleSnapshot();
+    this->scheduleCheckpoint();
+
+    if( this->solver == SOR_SOLVER && this->adaptiveRelaxation )
+    {
+        const double factor = this->relaxationEstimator->update(this->generationDelta);
+        for ( HeatMapWorker* worker : this->workers )
+            worker->setRelaxationFactor(factor);
+    }
+    this->generationDelta = 0.0;
+    this->equilibriumState = true;
+    return true;
+}
+
+void HeatMapEngine::publishSnapshot(bool always)
+{
+    // Jacobi leaves the last generation in the current matrix, the in-place solvers in the only one they use.
+    if( always || this->snapshotBuffer->isWanted() )
+    {
+        const TemperatureGrid* matrix = isInPlaceSolver(this->solver) || this->currentTemperatureMatrix->empty() ? this->previousTemperatureMatrix : this->currentTemperatureMatrix;
+        this->snapshotBuffer->publish(*matrix, this->generationCount);
+    }
+}
+
+void HeatMapEngine::scheduleSnapshot()
+{
+    if( !this->snapshotBuffer->isWanted() )
+        return;
+    SnapshotBuffer::Snapshot& snapshot = this->snapshotBuffer->reserve();
+    this->prepareTileCopy(snapshot.matrix);
+    snapshot.generation = this->generationCount;
+    for ( HeatMapWorker* worker : this->workers )
+        worker->setSnapshotMatrix(&snapshot.matrix);
+    this->snapshotPending = true;
+}
+
+void HeatMapEngine::finishSnapshot()
+{
+    this->snapshotPending = false;
+    for ( HeatMapWorker* worker : this->workers )
+        worker->setSnapshotMatrix(nullptr);
+    // The workers leave their tiles once a stop is requested, and the pool publishes the whole matrix as it stops.
+    if( !this->cancellationToken->isRequested() )
+        this->snapshotBuffer->commit();
+}
+
+void HeatMapEngine::prepareTileCopy(TemperatureGrid& target) const
+{
+    // The border never changes, so it is the only part copied here. The workers copy every tile they take on the
+    // next phase before updating it, which both Jacobi and the in-place solvers leave unchanged until then.
+    const TemperatureGrid& result = this->getResult();
+    if( target.getNumberOfRows() != result.getNumberOfRows() || target.getNumberOfColumns() != result.getNumberOfColumns() )
+        target.reshape( result.getNumberOfRows(), result.getNumberOfColumns() );
+    target.copyBorder(result);
+}
+
+bool HeatMapEngine::isCheckpointable() const
+{
+    if( this->haloExchange != nullptr )
+        return false;
+    return this->solver == JACOBI_SOLVER || this->solver == RED_BLACK_SOLVER || (this->solver == SOR_SOLVER && !this->adaptiveRelaxation);
+}
+
+CheckpointWriter::State HeatMapEngine::getCheckpointState() const
+{
+    CheckpointWriter::State state;
+    state.solver = this->solver;
+    state.epsilon = this->epsilon;
+    state.relaxationFactor = this->relaxationEstimator->getRelaxationFactor();
+    state.generationCount = this->generationCount;
+    state.solveSeconds = this->solveSeconds;
+    return state;
+}
+
+void HeatMapEngine::scheduleCheckpoint()
+{
+    if( this->checkpointPath.empty() || !this->isCheckpointable() || this->checkpointWriter->isBusy() )
+        return;
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if( std::chrono::duration<double>(now - this->lastCheckpoint).count() < this->checkpointInterval )
+        return;
+
+    this->checkpointState = this->getCheckpointState();
+    this->checkpointState.solveSeconds += std::chrono::duration<double>(now - this->solveStart).count();
+    this->lastCheckpoint = now;
+
+    TemperatureGrid& matrix = this->checkpointWriter->getMatrix();
+    this->prepareTileCopy(matrix);
+    for ( HeatMapWorker* worker : this->workers )
+        worker->setCheckpointMatrix(&matrix);
+    this->checkpointPending = true;
+}
+
+void HeatMapEngine::finishCheckpoint()
+{
+    this->checkpointPending = false;
+    for ( HeatMapWorker* worker : this->workers )
+        worker->setCheckpointMatrix(nullptr);
+    // The workers leave their tiles once a stop is requested, so the copy may be incomplete.
+    if( !this->cancellationToken->isRequested() )
+        this->checkpointWriter->submit(this->checkpointPath, this->checkpointState);
+}
+
+void HeatMapEngine::finishPlacement()
+{
+    this->placementPending = false;
+    this->previousTemperatureMatrix->copyBorder(*this->placementMatrix);
+    if( !this->currentTemperatureMatrix->empty() )
+        this->currentTemperatureMatrix->copyBorder(*this->placementMatrix);
+    this->placementMatrix->clear();
+
+    if( this->solver == CONJUGATE_GRADIENT_SOLVER )
+        this->conjugateGradientSolver->setup(this->previousTemperatureMatrix, this->preconditioner, this->tileScheduler->getTileCount());
+}
+
+void HeatMapEngine::recordPlacement()
+{
+    // A page shared by several rows of the same worker is counted once.
+    const size_t pageSize = NumaTopology::getPageSize();
+    for( int workerId = 0; workerId < static_cast<int>(this->workers.size()); ++workerId )
+    {
+        this->workerCpus.push_back( this->workers[workerId]->getCurrentCpu() );
+
+        std::vector<const void*> pages;
+        size_t firstTile = 0;
+        size_t finishTile = 0;
+        this->tileScheduler->getOwnTiles(workerId, firstTile, finishTile);
+        for( size_t tileIndex = firstTile; tileIndex < finishTile; ++tileIndex )
+        {
+            const TileScheduler::Tile& tile = this->tileScheduler->getTile(tileIndex);
+            for( size_t row = tile.startRow; row < tile.finishRow; ++row )
+            {
+                const size_t firstPage = reinterpret_cast<size_t>( this->previousTemperatureMatrix->interior(row) + tile.startColumn ) / pageSize;
+                const size_t lastPage = reinterpret_cast<size_t>( this->previousTemperatureMatrix->interior(row) + tile.finishColumn - 1 ) / pageSize;
+                for( size_t page = firstPage; page <= lastPage; ++page )
+                    if( pages.empty() || reinterpret_cast<size_t>(pages.back()) / pageSize < page )
+                        pages.push_back( reinterpret_cast<const void*>(page * pageSize) );
+            }
+        }
+        this->partitionPages.push_back( NumaTopology::countPagesPerNode(pages) );
+    }
+}
+
+bool HeatMapEngine::getEquilibriumState() const
+{
+    return this->equilibriumState;
+}
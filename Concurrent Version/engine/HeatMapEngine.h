@@ -0,0 +1,511 @@
+#ifndef HEATMAPENGINE_H
+#define HEATMAPENGINE_H
+
+#include <chrono>
+#include <string>
+
+#include "CheckpointWriter.h"
+#include "ConjugateGradientSolver.h"
+#include "MultigridSolver.h"
+#include "NumaTopology.h"
+#include "SnapshotBuffer.h"
+#include "Solver.h"
+#include "StencilKernel.h"
+#include "TileScheduler.h"
+
+class AsynchronousRelaxation;
+class CancellationToken;
+class FastPoissonSolver;
+class FileHandler;
+class GenerationBarrier;
+class HaloExchange;
+class HeatMapWorker;
+class RelaxationEstimator;
+class TemperatureGrid;
+
+/**
+ * @brief Simulates the heat exchange of a temperature matrix until it reaches the equilibrium state, without any
+ * dependency on Qt. The visualizer and the tester are front ends that load a matrix, configure the engine, run it
+ * from their own thread and read its results.
+ */
+class HeatMapEngine
+{
+private:
+    double epsilon = 0.0;
+    int threadCount = 0;
+    size_t tileHeight = 0;
+    size_t tileWidth = 0;
+    size_t generationsPerPass = 1;
+    StencilKernel::Variant kernelVariant = StencilKernel::getSelectedVariant();
+    bool workStealing = true;
+    TileScheduler::Decomposition decomposition = TileScheduler::ROW_STRIPES;
+    NumaTopology::Placement memoryPlacement = NumaTopology::LOADER_PLACEMENT;
+    std::vector<int> cpuAffinity;
+    Solver solver = JACOBI_SOLVER;
+    double relaxationFactor = 0.0;
+    bool adaptiveRelaxation = false;
+    MultigridSolver::Cycle multigridCycle = MultigridSolver::V_CYCLE;
+    ConjugateGradientSolver::Preconditioner preconditioner = ConjugateGradientSolver::JACOBI_PRECONDITIONER;
+    // Owned by the front end, only set when the matrix is a block of a distributed simulation.
+    HaloExchange * haloExchange = nullptr;
+
+    bool equilibriumState = false;
+    // A simulation continues across calls to run() and step(), even stopped ones, until a matrix is loaded or the solver changes.
+    bool simulationStarted = false;
+    size_t generationLimit = 0;
+    // Counters the next simulation starts from, set when a checkpoint is loaded.
+    size_t startGeneration = 0;
+    double startSeconds = 0.0;
+    // False when an in-place solver was stopped part way through a generation, so its matrix is no checkpoint.
+    bool generationCompleted = true;
+    // Set when the solver of the run left its work for a stop, not merely when one was requested as it finished.
+    bool stopped = false;
+    double stopLatency = 0.0;
+    TemperatureGrid * currentTemperatureMatrix = nullptr;
+    TemperatureGrid * previousTemperatureMatrix = nullptr;
+    // Holds the loaded matrix while the workers copy it into fresh pages.
+    TemperatureGrid * placementMatrix = nullptr;
+    bool placementPending = false;
+    // The workers are copying the snapshot reserved in the buffer during the current phase.
+    bool snapshotPending = false;
+
+    int finishedWorkerCount = 0;
+    int finishedPhaseCount = 0;
+    size_t generationCount = 0;
+    double generationDelta = 0.0;
+    double solveSeconds = 0.0;
+    std::vector< HeatMapWorker* > workers;
+    std::vector<int> workerCpus;
+    std::vector< std::vector<size_t> > partitionPages;
+
+    FileHandler * fileHandler = nullptr;
+    RelaxationEstimator * relaxationEstimator = nullptr;
+    MultigridSolver * multigridSolver = nullptr;
+    FastPoissonSolver * fastPoissonSolver = nullptr;
+    ConjugateGradientSolver * conjugateGradientSolver = nullptr;
+    AsynchronousRelaxation * asynchronousRelaxation = nullptr;
+    GenerationBarrier * generationBarrier = nullptr;
+    TileScheduler * tileScheduler = nullptr;
+    SnapshotBuffer * snapshotBuffer = nullptr;
+    CancellationToken * cancellationToken = nullptr;
+    CheckpointWriter * checkpointWriter = nullptr;
+    std::string checkpointPath;
+    double checkpointInterval = CHECKPOINT_DEFAULT_INTERVAL;
+    // The workers are copying a checkpoint with this state during the current phase.
+    bool checkpointPending = false;
+    CheckpointWriter::State checkpointState;
+    std::chrono::steady_clock::time_point lastCheckpoint;
+    std::chrono::steady_clock::time_point solveStart;
+
+public:
+    HeatMapEngine();
+    HeatMapEngine(const HeatMapEngine&) = delete;
+    HeatMapEngine& operator=(const HeatMapEngine&) = delete;
+    ~HeatMapEngine();
+
+    /**
+     * @brief Goes through the .csv file and parses it into the matrix of the next simulation. Files in the binary
+     * grid format are loaded without parsing.
+     * @return false if the file could not be opened.
+    */
+    bool loadFile(const std::string& filePath);
+
+    /**
+     * @brief Returns the megabytes per second the last file was read and parsed at, or zero if none was.
+    */
+    double getLoadThroughput() const;
+
+    /**
+     * @brief Returns the number of rows of the last file whose number of elements differs from the first row's.
+    */
+    size_t getRaggedRowCount() const;
+
+    /**
+     * @brief Copies the given matrix into the matrix of the next simulation. Its border is held fixed.
+    */
+    void loadMatrix(const TemperatureGrid& matrix);
+
+    /**
+     * @brief Loads a checkpoint, with its solver, epsilon and relaxation factor, so the next call to run() or step()
+     * continues the simulation from its generation and gives bit-exactly the same result as if it never stopped.
+     * @return false if the file is not a valid checkpoint.
+    */
+    bool loadCheckpoint(const std::string& filePath);
+
+    /**
+     * @brief Makes the simulation write a checkpoint of its last completed generation to the given file every given
+     * number of seconds. The workers copy the matrix among them during the next phase, each tile before updating it,
+     * and a writer thread writes it, so no worker waits for the whole copy or for the disk. A stop during that phase
+     * drops the checkpoint. Only Jacobi, red-black and SOR with a fixed relaxation factor continue bit-exactly from a
+     * matrix, so the other solvers and distributed simulations write none.
+     * @param filePath Path of the checkpoint, or an empty path to write none.
+     * @param intervalSeconds Seconds between two checkpoints.
+    */
+    void setCheckpointing(const std::string& filePath, double intervalSeconds);
+
+    /**
+     * @brief Writes a checkpoint of the last completed generation to the file given to setCheckpointing() and waits
+     * for it, together with the one being written in the background, if any. It must not be called while the
+     * simulation runs. An in-place solver stopped part way through a generation has no completed one, so only the
+     * last checkpoint written in the background is kept.
+     * @return false if there is no checkpoint file, the solver cannot be checkpointed, its generation is not
+     * complete or the file could not be written.
+    */
+    bool saveCheckpoint();
+
+    /**
+     * @brief Returns the generation of the last checkpoint written, or zero if none was.
+    */
+    size_t getCheckpointGeneration() const;
+
+    /**
+     * @brief Runs the simulation in the calling thread until the equilibrium state is reached or stop() is called.
+     * The first call after loading a matrix or changing the solver starts a new simulation, the next ones
+     * continue it from the last generation.
+     * @return true if the equilibrium state was reached.
+    */
+    bool run();
+
+    /**
+     * @brief Same as run(), but returns after the given number of generations at most. The solvers that advance
+     * several generations at once stop at the first pass that reaches it, and the direct solver ignores it.
+     * @return true if the equilibrium state was reached.
+    */
+    bool step(size_t generations);
+
+    /**
+     * @brief Stops the simulation from any thread. The workers stop within the band of rows they are sweeping, the
+     * asynchronous ones after their current sweep, and the multigrid solver after its current cycle, and run() or
+     * step() return false once they are joined. The direct solver cannot be stopped.
+     * The simulation is left where it can be resumed, so the next call continues it with its counters: Jacobi
+     * from the last completed generation, the in-place solvers from the cells they already updated, and conjugate
+     * gradient restarts its iterations from the current matrix. A stop is dropped when no run is in flight, so one
+     * that comes after run() or step() returned does not stop the next call.
+    */
+    void stop();
+
+    /**
+     * @brief Returns the seconds between the last call to stop() and the simulation returning, or zero if the last
+     * run was not stopped.
+    */
+    double getStopLatency() const;
+
+    /**
+     * @brief Returns the last completed generation, without copying it. It must not be read while the engine runs,
+     * acquireSnapshot() is meant for that.
+    */
+    const TemperatureGrid& getResult() const;
+
+    /**
+      * @brief Returns the number of rows of the matrix.
+      * @return The number of rows of the matrix.
+      */
+     size_t getNumberOfRows() const;
+
+    /**
+      * @brief Returns the number of columns of the matrix.
+      * @return The number of columns of the matrix.
+      */
+    size_t getNumberOfColumns() const;
+
+    /**
+      * @brief Returns true if the temperature matrix reached the equilibrium state and false if it didn't.
+      * @return The equilibrium state of the temperature matrix
+      */
+    bool getEquilibriumState() const;
+
+    /**
+      * @brief Sets the maximum change of a cell between two generations in the equilibrium state.
+      * @param epsilon Maximum temperature difference.
+      */
+    void setEpsilon(double epsilon);
+
+    /**
+      * @brief Returns the maximum change of a cell between two generations in the equilibrium state.
+      */
+    double getEpsilon() const;
+
+    /**
+      * @brief Sets the number of workers of the pool, capped by the cells of the matrix.
+      * @param threadCount Number of workers, or zero to use one per hardware thread.
+      */
+    void setThreadCount(int threadCount);
+
+    /**
+      * @brief Returns the number of workers set with setThreadCount(), zero meaning one per hardware thread.
+      */
+    int getThreadCount() const;
+
+    /**
+      * @brief Sets the shape of the tiles that workers sweep, so the rows they read stay in cache.
+      * Zero height and width keep the default traversal, one full row at a time.
+      * @param tileHeight Number of rows of each tile.
+      * @param tileWidth Number of columns of each tile.
+      */
+    void setTileShape(size_t tileHeight, size_t tileWidth);
+
+    /**
+      * @brief Returns the number of rows of each tile, or zero for the default traversal.
+      */
+    size_t getTileHeight() const;
+
+    /**
+      * @brief Returns the number of columns of each tile, or zero for the default traversal.
+      */
+    size_t getTileWidth() const;
+
+    /**
+      * @brief Sets how many generations the workers calculate on each tile before writing it back to the matrix.
+      * The result is bit-identical to plain Jacobi, but the equilibrium state is only checked after the last
+      * generation of each pass, so the simulation can run up to generationsPerPass - 1 generations past it.
+      * @param generationsPerPass Number of generations per pass. One disables temporal blocking.
+      */
+    void setTemporalBlocking(size_t generationsPerPass);
+
+    /**
+      * @brief Sets the variant of the stencil kernel the workers of this engine sweep Jacobi generations with, so
+      * engines in the same process can use different ones. Unsupported variants are ignored.
+      * @return true if the variant was selected.
+      */
+    bool setKernelVariant(StencilKernel::Variant kernelVariant);
+
+    /**
+      * @brief Returns the variant of the stencil kernel the workers sweep with. It starts as the selected one.
+      */
+    StencilKernel::Variant getKernelVariant() const;
+
+    /**
+      * @brief Makes the workers that run out of tiles steal them from the others, instead of waiting for them.
+      * Without it every worker sweeps the same fixed stripe of rows on every phase.
+      */
+    void setWorkStealing(bool workStealing);
+
+    /**
+      * @brief Selects how the interior is split among the workers. Blocks let more workers than rows share a
+      * matrix, and keep their borders short on tall and narrow matrices.
+      */
+    void setDecomposition(TileScheduler::Decomposition decomposition);
+
+    /**
+      * @brief Selects where the pages of the matrices are placed when the next simulation starts. Any placement
+      * other than the loader one copies the loaded matrix into fresh pages before the first generation.
+      */
+    void setMemoryPlacement(NumaTopology::Placement memoryPlacement);
+
+    /**
+      * @brief Pins every worker to a processor of the list, the first worker to the first processor and so on,
+      * wrapping around when there are more workers than processors. An empty list lets them run anywhere.
+      */
+    void setCpuAffinity(const std::vector<int>& cpuAffinity);
+
+    /**
+      * @brief Selects the numerical method used by the next simulation.
+      * Jacobi keeps two matrices, while red-black Gauss-Seidel updates the loaded matrix in place.
+      * @param solver The solver to use.
+      */
+    void setSolver(Solver solver);
+
+    /**
+      * @brief Returns the solver used by the simulation.
+      */
+    Solver getSolver() const;
+
+    /**
+      * @brief Sets the over-relaxation factor of the SOR solver.
+      * @param relaxationFactor A factor between one and two, or zero to use the optimal one for the dimensions of the matrix.
+      */
+    void setRelaxationFactor(double relaxationFactor);
+
+    /**
+      * @brief Makes the SOR solver start as Gauss-Seidel and raise its factor from the observed convergence rate,
+      * up to the one given to setRelaxationFactor().
+      */
+    void setAdaptiveRelaxation(bool adaptiveRelaxation);
+
+    /**
+      * @brief Returns the over-relaxation factor used in the last generation. It is one for the other solvers.
+      */
+    double getRelaxationFactor() const;
+
+    /**
+      * @brief Selects the cycle run by the multigrid solver.
+      */
+    void setMultigridCycle(MultigridSolver::Cycle cycle);
+
+    /**
+      * @brief Selects the preconditioner of the conjugate gradient solver.
+      */
+    void setPreconditioner(ConjugateGradientSolver::Preconditioner preconditioner);
+
+    /**
+      * @brief Makes the loaded matrix the block of this process in a distributed simulation. After every generation
+      * its halo is exchanged with the neighbouring processes, and the equilibrium state is the one of the whole
+      * matrix. Only Jacobi takes a single exchange per generation, so run() and step() fail with the other solvers,
+      * and temporal blocking is ignored. Every process must run the same number of generations, so stop() must be
+      * called on all of them.
+      * @param haloExchange The exchange already set up for the loaded block, or nullptr for a single process.
+      */
+    void setHaloExchange(HaloExchange * haloExchange);
+
+    /**
+      * @brief Returns the number of generations calculated since the simulation started. For the multigrid
+      * solver it is the number of cycles, for conjugate gradient the number of iterations, for the asynchronous
+      * solver the average number of sweeps of a worker, and the direct solver does not iterate, so it is zero.
+      */
+    size_t getGenerationCount() const;
+
+    /**
+      * @brief Returns the Euclidean norm of the residual after the last conjugate gradient iteration.
+      */
+    double getResidualNorm() const;
+
+    /**
+      * @brief Returns the average seconds between the last worker preparing the next phase and a worker starting it.
+      */
+    double getHandoffLatency() const;
+
+    /**
+      * @brief Returns the average seconds the last worker to finish a phase spent preparing the next one, while the
+      * others waited for it.
+      */
+    double getPhaseCompletionTime() const;
+
+    /**
+      * @brief Returns how many tiles each worker of the last simulation stole from the others.
+      */
+    std::vector<long long> getStolenTileCounts() const;
+
+    /**
+      * @brief Returns the seconds each worker of the last simulation spent waiting for the others at the end of a phase.
+      */
+    std::vector<double> getIdleSeconds() const;
+
+    /**
+      * @brief Returns the processor each worker of the last simulation started on, or -1 where it is unknown.
+      */
+    std::vector<int> getWorkerCpus() const;
+
+    /**
+      * @brief Returns, for each worker of the last simulation, how many pages of its own tiles were on each node
+      * when the first phase finished.
+      */
+    std::vector< std::vector<size_t> > getPartitionPages() const;
+
+    /**
+      * @brief Returns the newest generation published by the simulation, without stopping or waiting for it.
+      * The loaded matrix is published as generation zero, and the last generation is always published when the
+      * simulation ends. The asynchronous solver has no completed generation until its workers stop, so it only
+      * publishes that one. The snapshot stays unchanged until the next call, so only one consumer may call it.
+      */
+    const SnapshotBuffer::Snapshot& acquireSnapshot();
+
+    /**
+      * @brief Returns the seconds spent running the current simulation, or the last one, across every call to run() and step().
+      */
+    double getSolveSeconds() const;
+
+private:
+    /**
+      * @brief Starts a new simulation from the last completed generation, unless one is in progress, and runs it
+      * until the generation limit, if any.
+      * @return true if the equilibrium state was reached.
+      */
+    bool simulateHeatExchange();
+
+    /**
+      * @brief Resets the counters and the solvers for a new simulation, and leaves the last completed generation
+      * in the matrices the solver reads.
+      */
+    void startSimulation();
+
+    /**
+      * @brief Creates the workers, starts them and joins them once the pool stops.
+      */
+    void runPool();
+
+    /**
+      * @brief Runs multigrid cycles in the calling thread until the equilibrium state is reached.
+      */
+    void solveMultigrid();
+
+    /**
+      * @brief Computes the equilibrium state in one shot with the fast Poisson solver, in the calling thread.
+      */
+    void solveDirect();
+
+    /**
+      * @brief Returns true if the generation limit of the current call to step() was reached.
+      */
+    bool isGenerationLimitReached() const;
+
+    /**
+      * @brief Returns the number of Jacobi generations calculated on every pass over the matrix.
+      */
+    size_t getGenerationsPerPass() const;
+
+    /**
+      * @brief Runs on the last worker to finish a phase, while the others wait at the barrier. Adds up the phase
+      * and prepares the next one.
+      * @return false if the pool must stop, because the equilibrium state was reached or the simulation was stopped.
+      */
+    bool completePhase();
+
+    /**
+      * @brief Returns true if the solver of the simulation continues bit-exactly from a checkpoint.
+      */
+    bool isCheckpointable() const;
+
+    /**
+      * @brief Returns the state of the simulation after its last completed generation, as stored in a checkpoint.
+      */
+    CheckpointWriter::State getCheckpointState() const;
+
+    /**
+      * @brief Has the workers copy a checkpoint during the next phase once the interval since the last one passed,
+      * unless the last one is still being written.
+      */
+    void scheduleCheckpoint();
+
+    /**
+      * @brief Stops the workers copying the checkpoint and starts writing it in the background, unless a stop left
+      * some of its tiles out.
+      */
+    void finishCheckpoint();
+
+    /**
+      * @brief Copies the border of the loaded matrix once the workers copied their tiles, and releases it.
+      */
+    void finishPlacement();
+
+    /**
+      * @brief Records the processor of every worker and the nodes where the pages of its tiles are.
+      */
+    void recordPlacement();
+
+    /**
+      * @brief Publishes a copy of the last completed generation for the consumer of the snapshots.
+      * @param always Publish it even if the consumer did not take the previous one yet.
+      */
+    void publishSnapshot(bool always);
+
+    /**
+      * @brief Has the workers copy the last completed generation into the snapshot buffer during the next phase, if
+      * the consumer took the previous snapshot.
+      */
+    void scheduleSnapshot();
+
+    /**
+      * @brief Stops the workers copying the snapshot and publishes it, unless a stop left some of its tiles out.
+      */
+    void finishSnapshot();
+
+    /**
+      * @brief Gives the target the dimensions and the border of the last completed generation, so the workers only
+      * have to copy the interior into it.
+      */
+    void prepareTileCopy(TemperatureGrid& target) const;
+
+};
+
+#endif // HEATMAPENGINE_H
+
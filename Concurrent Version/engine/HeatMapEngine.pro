@@ -0,0 +1,64 @@
+# The simulation engine shared by the visualizer and the tester. It only needs the C++ standard library,
+# so it can be linked by any front end.
+
+CONFIG -= qt
+
+TARGET = HeatMapEngine
+TEMPLATE = lib
+
+CONFIG += staticlib c++17
+
+SOURCES += \
+    AsynchronousRelaxation.cpp \
+    AutoTuner.cpp \
+    BinaryGridFile.cpp \
+    CancellationToken.cpp \
+    CheckpointWriter.cpp \
+    ConjugateGradientSolver.cpp \
+    FastPoissonSolver.cpp \
+    FileHandler.cpp \
+    GenerationBarrier.cpp \
+    HaloExchange.cpp \
+    HeatMapEngine.cpp \
+    HeatMapWorker.cpp \
+    MappedFile.cpp \
+    MultigridSolver.cpp \
+    NumaTopology.cpp \
+    OutOfCoreSimulation.cpp \
+    RelaxationEstimator.cpp \
+    SnapshotBuffer.cpp \
+    SineTransform.cpp \
+    SocketTransport.cpp \
+    StencilKernel.cpp \
+    TemperatureGrid.cpp \
+    TemporalBlocker.cpp \
+    TileScheduler.cpp \
+    Transport.cpp
+
+HEADERS += \
+    AsynchronousRelaxation.h \
+    AutoTuner.h \
+    BinaryGridFile.h \
+    CancellationToken.h \
+    CheckpointWriter.h \
+    ConjugateGradientSolver.h \
+    FastPoissonSolver.h \
+    FileHandler.h \
+    GenerationBarrier.h \
+    HaloExchange.h \
+    HeatMapEngine.h \
+    HeatMapWorker.h \
+    MappedFile.h \
+    MultigridSolver.h \
+    NumaTopology.h \
+    OutOfCoreSimulation.h \
+    RelaxationEstimator.h \
+    SnapshotBuffer.h \
+    SineTransform.h \
+    SocketTransport.h \
+    Solver.h \
+    StencilKernel.h \
+    TemperatureGrid.h \
+    TemporalBlocker.h \
+    TileScheduler.h \
+    Transport.h
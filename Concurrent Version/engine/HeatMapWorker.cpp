@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "AsynchronousRelaxation.h"
+#include "CancellationToken.h"
+#include "ConjugateGradientSolver.h"
+#include "GenerationBarrier.h"
+#include "HeatMapWorker.h"
+#include "NumaTopology.h"
+#include "StencilKernel.h"
+#include "TemperatureGrid.h"
+#include "TemporalBlocker.h"
+#include "TileScheduler.h"
+
+HeatMapWorker::HeatMapWorker(int workerId, int workerCount, double epsilon, TemperatureGrid * previousTemperatureMatrix, TemperatureGrid * currentTemperatureMatrix
+                             , size_t tileHeight, size_t tileWidth, size_t generationsPerPass, Solver solver):
+    workerId(workerId)
+  , workerCount(workerCount)
+  , epsilon(epsilon)
+  , previousTemperatureMatrix(previousTemperatureMatrix)
+  , currentTemperatureMatrix(currentTemperatureMatrix)
+  , tileHeight(tileHeight)
+  , tileWidth(tileWidth)
+  , generationsPerPass(generationsPerPass)
+  , solver(solver)
+{
+    this->temporalBlocker = new TemporalBlocker();
+}
+
+HeatMapWorker::~HeatMapWorker()
+{
+    this->wait();
+    delete this->temporalBlocker;
+}
+
+void HeatMapWorker::start()
+{
+    this->thread = std::thread(&HeatMapWorker::run, this);
+}
+
+void HeatMapWorker::wait()
+{
+    if( this->thread.joinable() )
+        this->thread.join();
+}
+
+void HeatMapWorker::run()
+{
+    // The pool stays alive for the whole simulation, and meets at the barrier instead of exchanging signals.
+    if( this->cpu >= 0 )
+        NumaTopology::pinCurrentThread(this->cpu);
+    this->currentCpu = NumaTopology::getCurrentCpu();
+
+    if( this->solver == ASYNCHRONOUS_SOLVER )
+    {
+        this->asynchronousRelaxation->relax(this->workerId, this->cancellationToken);
+        return;
+    }
+
+    bool placing = this->placementSource != nullptr;
+    bool running = true;
+    while( running )
+    {
+        if( placing )
+            this->placeTiles();
+        else
+            this->updateTemperatures();
+        placing = false;
+        const std::chrono::steady_clock::time_point arrival = std::chrono::steady_clock::now();
+        running = this->generationBarrier->arriveAndWait();
+        const std::chrono::steady_clock::duration idle = std::chrono::steady_clock::now() - arrival;
+        this->tileScheduler->addIdleTime( this->workerId, std::chrono::duration_cast<std::chrono::nanoseconds>(idle).count() );
+    }
+}
+
+void HeatMapWorker::updateTemperatures()
+{
+    if( !isInPlaceSolver(this->solver) )
+    {
+        TemperatureGrid* temp = this->previousTemperatureMatrix;
+        this->previousTemperatureMatrix = this->currentTemperatureMatrix;
+        this->currentTemperatureMatrix = temp;
+    }
+    this->maximumDelta = 0.0;
+
+    // The border is a ghost frame that never changes, so the workers share only the interior cells among them.
+    // A stopped worker leaves the rest of its tiles, so the phase ends within a band of rows of every worker.
+    size_t tileIndex = 0;
+    while( !this->isStopRequested() && this->tileScheduler->takeTile(this->workerId, tileIndex) )
+    {
+        const TileScheduler::Tile& tile = this->tileScheduler->getTile(tileIndex);
+        double tileDelta = 0.0;
+        if( this->checkpointMatrix != nullptr )
+            this->copyTile(tile, this->checkpointMatrix);
+        if( this->snapshotMatrix != nullptr )
+            this->copyTile(tile, this->snapshotMatrix);
+
+        if( this->solver == CONJUGATE_GRADIENT_SOLVER )
+        {
+            // The solver keeps the partial sums of each tile, and the engine checks the equilibrium state once it adds them.
+            this->conjugateGradientSolver->runPhase(tile.startRow, tile.finishRow, tile.startColumn, tile.finishColumn, tileIndex);
+        }
+        else if( isRedBlackSolver(this->solver) )
+            tileDelta = this->sweepRedBlack(tile);
+        else if( this->generationsPerPass > 1 )
+            tileDelta = this->sweepTemporalBlocks(tile);
+        else
+            tileDelta = this->sweepJacobi(tile);
+
+        this->maximumDelta = std::max(this->maximumDelta, tileDelta);
+    }
+    this->nextColor ^= 1;
+}
+
+void HeatMapWorker::placeTiles()
+{
+    size_t firstTile = 0;
+    size_t finishTile = 0;
+    this->tileScheduler->getOwnTiles(this->workerId, firstTile, finishTile);
+    for( size_t tileIndex = firstTile; tileIndex < finishTile; ++tileIndex )
+    {
+        const TileScheduler::Tile& tile = this->tileScheduler->getTile(tileIndex);
+        const size_t bytes = (tile.finishColumn - tile.startColumn) * sizeof(double);
+        for( size_t row = tile.startRow; row < tile.finishRow; ++row )
+        {
+            const double* source = this->placementSource->interior(row) + tile.startColumn;
+            std::memcpy( this->previousTemperatureMatrix->interior(row) + tile.startColumn, source, bytes );
+            // The in-place solvers release the second matrix.
+            if( !this->currentTemperatureMatrix->empty() )
+                std::memcpy( this->currentTemperatureMatrix->interior(row) + tile.startColumn, source, bytes );
+        }
+    }
+}
+
+void HeatMapWorker::copyTile(const TileScheduler::Tile& tile, TemperatureGrid * target) const
+{
+    // Jacobi reads the generation from the previous matrix, and the in-place solvers only write the cells of the
+    // tile, which no other worker touches.
+    const size_t bytes = (tile.finishColumn - tile.startColumn) * sizeof(double);
+    for( size_t row = tile.startRow; row < tile.finishRow; ++row )
+        std::memcpy( target->interior(row) + tile.startColumn, this->previousTemperatureMatrix->interior(row) + tile.startColumn, bytes );
+}
+
+double HeatMapWorker::sweepJacobi(const TileScheduler::Tile& tile)
+{
+    const size_t stride = this->previousTemperatureMatrix->getStride();
+    const size_t columnCount = tile.finishColumn - tile.startColumn;
+    double maximumDelta = 0.0;
+
+    // Without a tile shape every band is a single row as wide as the tile.
+    const size_t bandHeight = this->tileHeight > 0 ? this->tileHeight : 1;
+
+    for( size_t row = tile.startRow; row < tile.finishRow && !this->isStopRequested(); row += bandHeight )
+    {
+        const size_t bandRows = std::min(bandHeight, tile.finishRow - row);
+        const double bandDelta = StencilKernel::sweepTiles( this->kernelVariant, this->previousTemperatureMatrix->interior(row) + tile.startColumn, this->currentTemperatureMatrix->interior(row) + tile.startColumn
+                                                          , stride, bandRows, columnCount, bandRows, this->tileWidth );
+        maximumDelta = std::max(maximumDelta, bandDelta);
+    }
+    return maximumDelta;
+}
+
+double HeatMapWorker::sweepTemporalBlocks(const TileScheduler::Tile& tile)
+{
+    double maximumDelta = 0.0;
+
+    // Temporal blocking needs tiles small enough to stay in cache, so it has a default shape.
+    const size_t tileRows = this->tileHeight > 0 ? this->tileHeight : TEMPORAL_TILE_HEIGHT;
+    const size_t tileColumns = this->tileWidth > 0 ? this->tileWidth : TEMPORAL_TILE_WIDTH;
+
+    for( size_t row = tile.startRow; row < tile.finishRow && !this->isStopRequested(); row += tileRows )
+    {
+        for( size_t column = tile.startColumn; column < tile.finishColumn; column += tileColumns )
+        {
+            const double tileDelta = this->temporalBlocker->advance( *this->previousTemperatureMatrix, *this->currentTemperatureMatrix, row, column
+                                                                   , std::min(tileRows, tile.finishRow - row), std::min(tileColumns, tile.finishColumn - column), this->generationsPerPass
+                                                                   , this->kernelVariant );
+            maximumDelta = std::max(maximumDelta, tileDelta);
+        }
+    }
+    return maximumDelta;
+}
+
+double HeatMapWorker::sweepRedBlack(const TileScheduler::Tile& tile)
+{
+    // The red-black solver works in place on the matrix loaded from the file, so only one matrix is used.
+    TemperatureGrid* matrix = this->previousTemperatureMatrix;
+    const size_t stride = matrix->getStride();
+    double maximumDelta = 0.0;
+
+    for( size_t row = tile.startRow; row < tile.finishRow && !this->isStopRequested(); ++row )
+    {
+        const double rowDelta = StencilKernel::sweepColor( matrix->interior(row) + tile.startColumn, stride, row, tile.startColumn, 1
+                                                         , tile.finishColumn - tile.startColumn, this->nextColor, this->relaxationFactor );
+        maximumDelta = std::max(maximumDelta, rowDelta);
+    }
+    return maximumDelta;
+}
+
+void HeatMapWorker::setRelaxationFactor(double relaxationFactor)
+{
+    this->relaxationFactor = relaxationFactor;
+}
+
+void HeatMapWorker::setKernelVariant(StencilKernel::Variant kernelVariant)
+{
+    this->kernelVariant = kernelVariant;
+}
+
+void HeatMapWorker::setCancellationToken(const CancellationToken * cancellationToken)
+{
+    this->cancellationToken = cancellationToken;
+}
+
+bool HeatMapWorker::isStopRequested() const
+{
+    return this->cancellationToken != nullptr && this->cancellationToken->isRequested();
+}
+
+void HeatMapWorker::setGenerationBarrier(GenerationBarrier * generationBarrier)
+{
+    this->generationBarrier = generationBarrier;
+}
+
+void HeatMapWorker::setCpu(int cpu)
+{
+    this->cpu = cpu;
+}
+
+int HeatMapWorker::getCurrentCpu() const
+{
+    return this->currentCpu;
+}
+
+void HeatMapWorker::setPlacementSource(const TemperatureGrid * placementSource)
+{
+    this->placementSource = placementSource;
+}
+
+void HeatMapWorker::setCheckpointMatrix(TemperatureGrid * checkpointMatrix)
+{
+    this->checkpointMatrix = checkpointMatrix;
+}
+
+void HeatMapWorker::setSnapshotMatrix(TemperatureGrid * snapshotMatrix)
+{
+    this->snapshotMatrix = snapshotMatrix;
+}
+
+void HeatMapWorker::setTileScheduler(TileScheduler * tileScheduler)
+{
+    this->tileScheduler = tileScheduler;
+}
+
+void HeatMapWorker::setConjugateGradientSolver(ConjugateGradientSolver * conjugateGradientSolver)
+{
+    this->conjugateGradientSolver = conjugateGradientSolver;
+}
+
+void HeatMapWorker::setAsynchronousRelaxation(AsynchronousRelaxation * asynchronousRelaxation)
+{
+    this->asynchronousRelaxation = asynchronousRelaxation;
+}
+
+double HeatMapWorker::getMaximumDelta() const
+{
+    return this->maximumDelta;
+}
+
+size_t HeatMapWorker::calculateStart(const size_t& rowCount, const int& workerCount, const int& workerId)
+{
+    const size_t equitative = workerId * ((rowCount) / workerCount);
+    const size_t overload = std::min(static_cast<size_t>(workerId), (rowCount) % workerCount);
+    return equitative + overload;
+}
+
+size_t HeatMapWorker::calculateFinish(const size_t &rowCount, const int &workerCount, const int &workerId)
+{
+    return calculateStart(rowCount, workerCount, workerId + 1);
+}
+
@@ -0,0 +1,212 @@
+#ifndef HEATMAPWORKER_H
+#define HEATMAPWORKER_H
+
+#include <thread>
+
+#include "Solver.h"
+#include "StencilKernel.h"
+#include "TileScheduler.h"
+
+// Default tile shape when several generations are calculated per pass and no tile shape was given.
+#define TEMPORAL_TILE_HEIGHT 64
+#define TEMPORAL_TILE_WIDTH 256
+
+class AsynchronousRelaxation;
+class CancellationToken;
+class ConjugateGradientSolver;
+class GenerationBarrier;
+class TemperatureGrid;
+class TemporalBlocker;
+
+class HeatMapWorker
+{
+private:
+    std::thread thread;
+    const CancellationToken * cancellationToken = nullptr;
+
+    int workerId = -1;
+    int workerCount = -1;
+    double epsilon = 0.0;
+
+    TemperatureGrid * previousTemperatureMatrix = nullptr;
+    TemperatureGrid * currentTemperatureMatrix = nullptr;
+
+    size_t tileHeight = 0;
+    size_t tileWidth = 0;
+    size_t generationsPerPass = 1;
+    StencilKernel::Variant kernelVariant = StencilKernel::getSelectedVariant();
+
+    Solver solver = JACOBI_SOLVER;
+    int nextColor = 0;
+    double relaxationFactor = 1.0;
+    double maximumDelta = 0.0;
+
+    TemporalBlocker * temporalBlocker = nullptr;
+    ConjugateGradientSolver * conjugateGradientSolver = nullptr;
+    AsynchronousRelaxation * asynchronousRelaxation = nullptr;
+    GenerationBarrier * generationBarrier = nullptr;
+    TileScheduler * tileScheduler = nullptr;
+
+    int cpu = -1;
+    int currentCpu = -1;
+    const TemperatureGrid * placementSource = nullptr;
+    TemperatureGrid * checkpointMatrix = nullptr;
+    TemperatureGrid * snapshotMatrix = nullptr;
+
+public:
+    explicit HeatMapWorker(int workerId, int workerCount, double epsilon, TemperatureGrid * previousTemperatureMatrix, TemperatureGrid * currentTemperatureMatrix
+                           , size_t tileHeight = 0, size_t tileWidth = 0, size_t generationsPerPass = 1, Solver solver = JACOBI_SOLVER);
+    HeatMapWorker(const HeatMapWorker&) = delete;
+    HeatMapWorker& operator=(const HeatMapWorker&) = delete;
+    ~HeatMapWorker();
+
+    /**
+    * @brief Starts a thread that runs run().
+    */
+    void start();
+
+    /**
+    * @brief Waits for the thread started by start() to leave the pool.
+    */
+    void wait();
+
+    /**
+    * @brief Runs phases until the completion function of the barrier stops the pool. The time spent waiting at
+    * the barrier is added to the idle time of the worker in the scheduler. With a placement source, the first
+    * phase only copies the tiles of the worker into the matrices. With the asynchronous solver the worker relaxes its
+    * block until the relaxation ends, and never meets the others at the barrier.
+    */
+    void run();
+
+    /**
+    * @brief Updates the tiles the worker takes from the scheduler for one phase, until none is left. With temporal blocking the worker advances several
+    * generations in a single pass. With the red-black solver every phase updates only one colour, so a generation
+    * takes two of them, and with conjugate gradient every phase is one step of an iteration.
+    */
+    void updateTemperatures();
+
+    /**
+    * @brief Calculates the start row of each worker
+    * @param Amount of rows in the matrix
+    * @param Amount of workers
+    * @param Id of each worker
+    * @return start row
+    */
+    static size_t calculateStart(const size_t& rowCount, const int& workerCount, const int& workerId);
+    /**
+    * @brief Calculates the finish row of each worker
+    * @param Amount of rows in the matrix
+    * @param Amount of workers
+    * @param Id of each worker
+    * @return finish row
+    */
+    static size_t calculateFinish(const size_t& rowCount, const int& workerCount, const int& workerId);
+
+    /**
+    * @brief Sets the over-relaxation factor of the SOR solver. It must not be changed while the worker is updating its rows.
+    */
+    void setRelaxationFactor(double relaxationFactor);
+
+    /**
+    * @brief Sets the variant of the stencil kernel the worker sweeps Jacobi generations with.
+    */
+    void setKernelVariant(StencilKernel::Variant kernelVariant);
+
+    /**
+    * @brief Sets the token that makes the worker leave its tiles unfinished once a stop is requested. The engine owns it.
+    */
+    void setCancellationToken(const CancellationToken * cancellationToken);
+
+    /**
+    * @brief Sets the barrier where the pool meets after every phase. The engine owns it.
+    */
+    void setGenerationBarrier(GenerationBarrier * generationBarrier);
+
+    /**
+    * @brief Sets the scheduler the worker takes its tiles from. The engine owns it and shares it among all the workers.
+    */
+    void setTileScheduler(TileScheduler * tileScheduler);
+
+    /**
+    * @brief Pins the thread of the worker to the given processor when it starts. A negative one lets it run anywhere.
+    */
+    void setCpu(int cpu);
+
+    /**
+    * @brief Returns the processor the worker was running on when it started, or -1 if it is unknown.
+    */
+    int getCurrentCpu() const;
+
+    /**
+    * @brief Sets the matrix whose interior the worker copies into its own tiles before the first phase, so their
+    * pages are placed on its node. The engine owns it.
+    */
+    void setPlacementSource(const TemperatureGrid * placementSource);
+
+    /**
+    * @brief Sets the matrix the worker copies every tile it takes into, before updating it, so the workers copy a
+    * checkpoint of the generation the phase starts from among them. It must not be changed while the worker is
+    * updating its rows, and nullptr copies nothing. The engine owns it.
+    */
+    void setCheckpointMatrix(TemperatureGrid * checkpointMatrix);
+
+    /**
+    * @brief Same as setCheckpointMatrix(), for the snapshot the engine publishes for the consumer.
+    */
+    void setSnapshotMatrix(TemperatureGrid * snapshotMatrix);
+
+    /**
+    * @brief Sets the solver whose phases the worker runs on its rows when the solver is conjugate gradient.
+    * The engine owns it and shares it among all the workers.
+    */
+    void setConjugateGradientSolver(ConjugateGradientSolver * conjugateGradientSolver);
+
+    /**
+    * @brief Sets the relaxation whose block the worker sweeps when the solver is asynchronous.
+    * The engine owns it and shares it among all the workers.
+    */
+    void setAsynchronousRelaxation(AsynchronousRelaxation * asynchronousRelaxation);
+
+    /**
+    * @brief Returns the maximum change of a cell in the last call to updateTemperatures().
+    */
+    double getMaximumDelta() const;
+
+private:
+    /**
+    * @brief Returns true once a stop was requested through the token.
+    */
+    bool isStopRequested() const;
+
+    /**
+    * @brief Copies the interior of the tiles dealt to the worker from the placement source into both matrices.
+    * Tiles are not stolen, so each one is written first by its owner.
+    */
+    void placeTiles();
+
+    /**
+    * @brief Copies the interior of the given tile, as the phase found it, into the given matrix.
+    */
+    void copyTile(const TileScheduler::Tile& tile, TemperatureGrid * target) const;
+
+    /**
+    * @brief Calculates the next generation of the given tile, reading the previous matrix and writing the current one.
+    * @return The maximum change of a cell
+    */
+    double sweepJacobi(const TileScheduler::Tile& tile);
+
+    /**
+    * @brief Advances the given tile generationsPerPass generations, cache tile by cache tile.
+    * @return The maximum change of a cell in the last generation
+    */
+    double sweepTemporalBlocks(const TileScheduler::Tile& tile);
+
+    /**
+    * @brief Updates in place the cells of the next colour in the given tile, over-relaxed by the relaxation factor.
+    * Red and black alternate on every phase.
+    * @return The maximum change of a cell
+    */
+    double sweepRedBlack(const TileScheduler::Tile& tile);
+};
+
+#endif // HEATMAPWORKER_H
@@ -0,0 +1,85 @@
+#include <fstream>
+#include <iterator>
+
+#include "MappedFile.h"
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+    this->close();
+}
+
+bool MappedFile::open(const std::string& filePath)
+{
+    this->close();
+    if( filePath.empty() )
+        return false;
+
+#ifdef __unix__
+    const int descriptor = ::open(filePath.c_str(), O_RDONLY);
+    if( descriptor < 0 )
+        return false;
+    struct stat status;
+    if( ::fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode) )
+    {
+        // An empty file cannot be mapped, and needs nothing to be read.
+        this->size = static_cast<size_t>(status.st_size);
+        void* address = this->size > 0 ? ::mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, descriptor, 0) : MAP_FAILED;
+        if( address != MAP_FAILED )
+        {
+            // The file is read once from the start to the end, so the kernel can read ahead aggressively.
+            ::madvise(address, this->size, MADV_SEQUENTIAL);
+            this->data = static_cast<const char*>(address);
+            this->mapped = true;
+        }
+        ::close(descriptor);
+        if( this->mapped || this->size == 0 )
+            return true;
+        this->size = 0;
+    }
+    else
+        ::close(descriptor);
+#endif
+
+    // Pipes and other files without a size are read until their end.
+    std::ifstream file(filePath, std::ios::binary);
+    if( !file.is_open() )
+        return false;
+    this->buffer.assign( std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() );
+    this->data = this->buffer.empty() ? nullptr : this->buffer.data();
+    this->size = this->buffer.size();
+    return true;
+}
+
+void MappedFile::close()
+{
+#ifdef __unix__
+    if( this->mapped )
+        ::munmap( const_cast<char*>(this->data), this->size );
+#endif
+    this->mapped = false;
+    this->data = nullptr;
+    this->size = 0;
+    this->buffer.clear();
+    this->buffer.shrink_to_fit();
+}
+
+const char* MappedFile::getData() const
+{
+    return this->data;
+}
+
+size_t MappedFile::getSize() const
+{
+    return this->size;
+}
@@ -0,0 +1,49 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Read-only view of a whole file. On Unix the file is memory mapped, so its pages are read straight from the page
+ * cache as they are touched instead of being copied through a stream buffer. Other systems, and files that cannot
+ * be mapped, are read into a buffer instead.
+ */
+class MappedFile
+{
+private:
+    const char * data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    std::vector<char> buffer;
+
+public:
+    MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    /**
+     * @brief Maps the given file, replacing the one mapped before.
+     * @return false if the file could not be opened.
+     */
+    bool open(const std::string& filePath);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    void close();
+
+    /**
+     * @brief Returns the first byte of the file, or nullptr if it is empty.
+     */
+    const char* getData() const;
+
+    /**
+     * @brief Returns the number of bytes of the file.
+     */
+    size_t getSize() const;
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <cmath>
+
+#include "MultigridSolver.h"
+
+const char* MultigridSolver::getCycleName(Cycle cycle)
+{
+    static const char* const names[] = { "v", "w", "fmg" };
+    return ( cycle >= V_CYCLE && cycle < CYCLE_COUNT ) ? names[cycle] : "unknown";
+}
+
+MultigridSolver::MultigridSolver()
+{}
+
+void MultigridSolver::setup(TemperatureGrid * matrix, Cycle cycle)
+{
+    this->matrix = matrix;
+    this->cycle = cycle;
+    this->cycleCount = 0;
+    this->levels.clear();
+
+    size_t interiorRows = matrix->getInteriorRows();
+    size_t interiorColumns = matrix->getInteriorColumns();
+    while( true )
+    {
+        this->levels.emplace_back();
+        Level& level = this->levels.back();
+        level.rightHandSide.resize(interiorRows + 2, interiorColumns + 2);
+        level.residual.resize(interiorRows + 2, interiorColumns + 2);
+        // The finest level works on the matrix itself.
+        if( this->levels.size() > 1 )
+            level.solution.resize(interiorRows + 2, interiorColumns + 2);
+
+        if( interiorRows < MULTIGRID_COARSEST_SIZE || interiorColumns < MULTIGRID_COARSEST_SIZE )
+            break;
+        const size_t coarseRows = interiorRows / 2;
+        const size_t coarseColumns = interiorColumns / 2;
+        mapDimension(interiorRows, coarseRows, level.rowIndex, level.rowWeight);
+        mapDimension(interiorColumns, coarseColumns, level.columnIndex, level.columnWeight);
+        interiorRows = coarseRows;
+        interiorColumns = coarseColumns;
+    }
+}
+
+double MultigridSolver::iterate()
+{
+    if( this->matrix == nullptr || this->matrix->getInteriorRows() == 0 || this->matrix->getInteriorColumns() == 0 )
+        return 0.0;
+
+    if( this->cycle == FULL_MULTIGRID && this->cycleCount == 0 )
+        this->runFullMultigrid(0);
+    else
+        this->runCycle(0, this->cycle == W_CYCLE ? 2 : 1);
+    ++this->cycleCount;
+
+    // Without sources, a Jacobi generation would move every cell a quarter of its residual.
+    return computeResidual(*this->matrix, this->levels[0].rightHandSide, this->levels[0].residual) / 4.0;
+}
+
+size_t MultigridSolver::getCycleCount() const
+{
+    return this->cycleCount;
+}
+
+size_t MultigridSolver::getLevelCount() const
+{
+    return this->levels.size();
+}
+
+TemperatureGrid& MultigridSolver::getSolution(size_t level)
+{
+    return level == 0 ? *this->matrix : this->levels[level].solution;
+}
+
+void MultigridSolver::runCycle(size_t level, int coarseCycles)
+{
+    TemperatureGrid& solution = this->getSolution(level);
+    const TemperatureGrid& rightHandSide = this->levels[level].rightHandSide;
+    if( level + 1 == this->levels.size() )
+    {
+        this->solveCoarsest(level);
+        return;
+    }
+
+    smooth(solution, rightHandSide, MULTIGRID_SMOOTHING_SWEEPS);
+    computeResidual(solution, rightHandSide, this->levels[level].residual);
+    this->restrictResidual(level);
+
+    // The coarser level solves for the error, which is zero on the border.
+    this->levels[level + 1].solution.fill(0.0);
+    for( int coarseCycle = 0; coarseCycle < coarseCycles; ++coarseCycle )
+        this->runCycle(level + 1, coarseCycles);
+
+    this->prolongate(level, true);
+    smooth(solution, rightHandSide, MULTIGRID_SMOOTHING_SWEEPS);
+}
+
+void MultigridSolver::runFullMultigrid(size_t level)
+{
+    if( level + 1 == this->levels.size() )
+    {
+        this->solveCoarsest(level);
+        return;
+    }
+
+    // The coarser level solves the same Laplace problem, with its border sampled from this one.
+    TemperatureGrid& coarse = this->levels[level + 1].solution;
+    coarse.fill(0.0);
+    this->restrictBorder(level);
+    this->levels[level + 1].rightHandSide.fill(0.0);
+    this->runFullMultigrid(level + 1);
+
+    this->prolongate(level, false);
+    this->runCycle(level, 1);
+}
+
+void MultigridSolver::solveCoarsest(size_t level)
+{
+    TemperatureGrid& solution = this->getSolution(level);
+    const TemperatureGrid& rightHandSide = this->levels[level].rightHandSide;
+    TemperatureGrid& residual = this->levels[level].residual;
+
+    const double target = computeResidual(solution, rightHandSide, residual) * MULTIGRID_COARSEST_REDUCTION;
+    for( int sweep = 0; sweep < MULTIGRID_COARSEST_SWEEPS; sweep += MULTIGRID_SMOOTHING_SWEEPS )
+    {
+        smooth(solution, rightHandSide, MULTIGRID_SMOOTHING_SWEEPS);
+        if( computeResidual(solution, rightHandSide, residual) <= target )
+            break;
+    }
+}
+
+void MultigridSolver::smooth(TemperatureGrid& solution, const TemperatureGrid& rightHandSide, int sweeps)
+{
+    const size_t rows = solution.getInteriorRows();
+    const size_t columns = solution.getInteriorColumns();
+    const size_t stride = solution.getStride();
+
+    for( int sweep = 0; sweep < sweeps; ++sweep )
+    {
+        for( int color = 0; color < 2; ++color )
+        {
+            for( size_t row = 0; row < rows; ++row )
+            {
+                double* center = solution.interior(row);
+                const double* source = rightHandSide.interior(row);
+                for( size_t column = (row + color) & 1; column < columns; column += 2 )
+                    center[column] = ( center[column + 1] + center[column - 1] + center[column - stride] + center[column + stride] + source[column] ) * 0.25;
+            }
+        }
+    }
+}
+
+double MultigridSolver::computeResidual(const TemperatureGrid& solution, const TemperatureGrid& rightHandSide, TemperatureGrid& residual)
+{
+    const size_t rows = solution.getInteriorRows();
+    const size_t columns = solution.getInteriorColumns();
+    const size_t stride = solution.getStride();
+
+    double maximumResidual = 0.0;
+    for( size_t row = 0; row < rows; ++row )
+    {
+        const double* center = solution.interior(row);
+        const double* source = rightHandSide.interior(row);
+        double* target = residual.interior(row);
+        for( size_t column = 0; column < columns; ++column )
+        {
+            const double sum = center[column + 1] + center[column - 1] + center[column - stride] + center[column + stride];
+            target[column] = source[column] + sum - 4.0 * center[column];
+            maximumResidual = std::max( maximumResidual, std::fabs(target[column]) );
+        }
+    }
+    return maximumResidual;
+}
+
+void MultigridSolver::restrictResidual(size_t level)
+{
+    const Level& fine = this->levels[level];
+    TemperatureGrid& coarse = this->levels[level + 1].rightHandSide;
+    coarse.fill(0.0);
+
+    // Every fine cell gives its residual to the four coarse cells around it. The coarse grid is spaced twice as
+    // far, so its equation is scaled by four, which cancels the quarter of the full weighting stencil.
+    for( size_t row = 1; row <= fine.residual.getInteriorRows(); ++row )
+    {
+        const size_t coarseRow = fine.rowIndex[row];
+        const double lowerWeight = fine.rowWeight[row];
+        const double* source = fine.residual.row(row);
+        double* upper = coarse.row(coarseRow);
+        double* lower = coarse.row(coarseRow + 1);
+        for( size_t column = 1; column <= fine.residual.getInteriorColumns(); ++column )
+        {
+            const size_t coarseColumn = fine.columnIndex[column];
+            const double rightWeight = fine.columnWeight[column];
+            const double upperValue = source[column] * (1.0 - lowerWeight);
+            const double lowerValue = source[column] * lowerWeight;
+            upper[coarseColumn] += upperValue * (1.0 - rightWeight);
+            upper[coarseColumn + 1] += upperValue * rightWeight;
+            lower[coarseColumn] += lowerValue * (1.0 - rightWeight);
+            lower[coarseColumn + 1] += lowerValue * rightWeight;
+        }
+    }
+    // The border of the coarse grid received weights too, but it is never read as a right hand side.
+}
+
+void MultigridSolver::restrictBorder(size_t level)
+{
+    const TemperatureGrid& fine = this->getSolution(level);
+    TemperatureGrid& coarse = this->levels[level + 1].solution;
+    const size_t fineLastRow = fine.getNumberOfRows() - 1;
+    const size_t fineLastColumn = fine.getNumberOfColumns() - 1;
+    const size_t coarseLastRow = coarse.getNumberOfRows() - 1;
+    const size_t coarseLastColumn = coarse.getNumberOfColumns() - 1;
+
+    // Samples a fine border row or column at the position of a coarse cell, interpolating between its two nearest cells.
+    auto sample = [](const double* cells, size_t step, size_t fineLast, size_t coarseLast, size_t coarseIndex)
+    {
+        const double position = static_cast<double>(coarseIndex) * fineLast / coarseLast;
+        const size_t index = std::min( static_cast<size_t>(position), fineLast - 1 );
+        const double weight = position - index;
+        return cells[index * step] * (1.0 - weight) + cells[(index + 1) * step] * weight;
+    };
+
+    for( size_t column = 0; column <= coarseLastColumn; ++column )
+    {
+        coarse(0, column) = sample(fine.row(0), 1, fineLastColumn, coarseLastColumn, column);
+        coarse(coarseLastRow, column) = sample(fine.row(fineLastRow), 1, fineLastColumn, coarseLastColumn, column);
+    }
+    for( size_t row = 0; row <= coarseLastRow; ++row )
+    {
+        coarse(row, 0) = sample(fine.row(0), fine.getStride(), fineLastRow, coarseLastRow, row);
+        coarse(row, coarseLastColumn) = sample(fine.row(0) + fineLastColumn, fine.getStride(), fineLastRow, coarseLastRow, row);
+    }
+}
+
+void MultigridSolver::prolongate(size_t level, bool accumulate)
+{
+    const Level& fineLevel = this->levels[level];
+    TemperatureGrid& fine = this->getSolution(level);
+    const TemperatureGrid& coarse = this->levels[level + 1].solution;
+
+    for( size_t row = 1; row <= fine.getInteriorRows(); ++row )
+    {
+        const size_t coarseRow = fineLevel.rowIndex[row];
+        const double lowerWeight = fineLevel.rowWeight[row];
+        const double* upper = coarse.row(coarseRow);
+        const double* lower = coarse.row(coarseRow + 1);
+        double* target = fine.row(row);
+        for( size_t column = 1; column <= fine.getInteriorColumns(); ++column )
+        {
+            const size_t coarseColumn = fineLevel.columnIndex[column];
+            const double rightWeight = fineLevel.columnWeight[column];
+            const double upperValue = upper[coarseColumn] * (1.0 - rightWeight) + upper[coarseColumn + 1] * rightWeight;
+            const double lowerValue = lower[coarseColumn] * (1.0 - rightWeight) + lower[coarseColumn + 1] * rightWeight;
+            const double value = upperValue * (1.0 - lowerWeight) + lowerValue * lowerWeight;
+            target[column] = accumulate ? target[column] + value : value;
+        }
+    }
+}
+
+void MultigridSolver::mapDimension(size_t fineCount, size_t coarseCount, std::vector<size_t>& index, std::vector<double>& weight)
+{
+    // Both borders are at the same place on every level, so a fine cell lies at the coarse position
+    // x * (coarseCount + 1) / (fineCount + 1). With an odd count every other fine cell matches a coarse one.
+    index.assign(fineCount + 2, 0);
+    weight.assign(fineCount + 2, 0.0);
+    for( size_t fine = 1; fine <= fineCount; ++fine )
+    {
+        const size_t numerator = fine * (coarseCount + 1);
+        index[fine] = numerator / (fineCount + 1);
+        weight[fine] = static_cast<double>(numerator % (fineCount + 1)) / (fineCount + 1);
+    }
+}
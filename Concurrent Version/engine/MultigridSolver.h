@@ -0,0 +1,145 @@
+#ifndef MULTIGRIDSOLVER_H
+#define MULTIGRIDSOLVER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "TemperatureGrid.h"
+
+// Red-black sweeps before and after the coarse grid correction of each level.
+#define MULTIGRID_SMOOTHING_SWEEPS 2
+// Levels stop being coarsened when a dimension of their interior is below this size.
+#define MULTIGRID_COARSEST_SIZE 3
+// Sweeps allowed to solve the coarsest level, and the residual reduction at which they stop.
+#define MULTIGRID_COARSEST_SWEEPS 1000
+#define MULTIGRID_COARSEST_REDUCTION 1e-3
+
+/**
+ * Solves the equilibrium state directly, as Laplace's equation with the border of the matrix held fixed.
+ * Each level has half the interior rows and columns of the previous one, rounded down, so any size can be
+ * coarsened. The transfers between levels interpolate linearly along each dimension, and restriction is the
+ * transpose of that interpolation. A red-black Gauss-Seidel sweep smooths the error on every level.
+ */
+class MultigridSolver
+{
+public:
+    /**
+     * @brief Order in which the levels are visited by each call to iterate().
+     */
+    enum Cycle
+    {
+        // Each level is corrected once by the next coarser one.
+        V_CYCLE,
+        // Each level is corrected twice by the next coarser one, which is slower but more robust.
+        W_CYCLE,
+        // The first cycle solves the coarser levels first and interpolates them as the initial guess, the rest are V cycles.
+        FULL_MULTIGRID,
+        CYCLE_COUNT
+    };
+
+    /**
+     * @brief Returns the name used to select the given cycle from the command line.
+     */
+    static const char* getCycleName(Cycle cycle);
+
+private:
+    /**
+     * Grids of one level, plus the weights that map each of its interior rows and columns to the next coarser level.
+     */
+    struct Level
+    {
+        TemperatureGrid solution;
+        TemperatureGrid rightHandSide;
+        TemperatureGrid residual;
+        std::vector<size_t> rowIndex;
+        std::vector<double> rowWeight;
+        std::vector<size_t> columnIndex;
+        std::vector<double> columnWeight;
+    };
+
+    TemperatureGrid * matrix = nullptr;
+    Cycle cycle = V_CYCLE;
+    size_t cycleCount = 0;
+    std::vector<Level> levels;
+
+public:
+    MultigridSolver();
+
+    /**
+     * @brief Builds the levels for the given matrix. The matrix is updated in place by iterate(), so it must outlive the solver.
+     * @param matrix Matrix whose border is held fixed. Its interior is used as the initial guess, except for full multigrid.
+     * @param cycle Cycle run by iterate().
+     */
+    void setup(TemperatureGrid * matrix, Cycle cycle);
+
+    /**
+     * @brief Runs one cycle on the matrix.
+     * @return The maximum change a Jacobi generation would make now, comparable with the epsilon of the other solvers.
+     */
+    double iterate();
+
+    /**
+     * @brief Returns the number of cycles run since setup().
+     */
+    size_t getCycleCount() const;
+
+    /**
+     * @brief Returns the number of levels, the matrix included.
+     */
+    size_t getLevelCount() const;
+
+private:
+    /**
+     * @brief Returns the solution grid of the given level. The one of the finest level is the matrix.
+     */
+    TemperatureGrid& getSolution(size_t level);
+
+    /**
+     * @brief Visits the levels below the given one in a V cycle, or a W cycle if coarseCycles is two.
+     */
+    void runCycle(size_t level, int coarseCycles);
+
+    /**
+     * @brief Solves the problem on the coarser levels first and interpolates it as the initial guess of the given level.
+     */
+    void runFullMultigrid(size_t level);
+
+    /**
+     * @brief Smooths the coarsest level until its residual is small enough.
+     */
+    void solveCoarsest(size_t level);
+
+    /**
+     * @brief Updates in place every interior cell of the solution with red-black Gauss-Seidel.
+     */
+    static void smooth(TemperatureGrid& solution, const TemperatureGrid& rightHandSide, int sweeps);
+
+    /**
+     * @brief Writes the residual of the five point Laplacian of the solution and returns its maximum absolute value.
+     */
+    static double computeResidual(const TemperatureGrid& solution, const TemperatureGrid& rightHandSide, TemperatureGrid& residual);
+
+    /**
+     * @brief Writes into the right hand side of the next coarser level the residual of this level, weighted by the
+     * transpose of the interpolation.
+     */
+    void restrictResidual(size_t level);
+
+    /**
+     * @brief Interpolates the border of the given level into the border of the next coarser one.
+     */
+    void restrictBorder(size_t level);
+
+    /**
+     * @brief Interpolates the solution of the next coarser level into the interior of the given one.
+     * @param accumulate Adds the interpolation, as a correction, instead of replacing the interior with it.
+     */
+    void prolongate(size_t level, bool accumulate);
+
+    /**
+     * @brief Calculates for every interior index of a dimension the index and weight of the coarser cells it lies between.
+     */
+    static void mapDimension(size_t fineCount, size_t coarseCount, std::vector<size_t>& index, std::vector<double>& weight);
+};
+
+#endif // MULTIGRIDSOLVER_H
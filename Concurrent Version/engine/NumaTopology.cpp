@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "NumaTopology.h"
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Values of numaif.h, which is only installed with the NUMA library.
+#define NUMA_POLICY_INTERLEAVE 3
+#endif
+
+// Highest node number the memory policy masks can describe.
+#define NUMA_MAXIMUM_NODES 64
+
+static std::vector<int> parseCpuList(const std::string& list)
+{
+    // The kernel writes ranges separated by commas, like 0-3,8-11.
+    std::vector<int> cpus;
+    std::stringstream ranges(list);
+    std::string range;
+    while( std::getline(ranges, range, ',') )
+    {
+        const size_t dash = range.find('-');
+        try
+        {
+            const int first = std::stoi( range.substr(0, dash) );
+            const int last = dash == std::string::npos ? first : std::stoi( range.substr(dash + 1) );
+            for( int cpu = first; cpu <= last; ++cpu )
+                cpus.push_back(cpu);
+        }
+        catch( const std::exception& )
+        {
+        }
+    }
+    return cpus;
+}
+
+const char* NumaTopology::getPlacementName(Placement placement)
+{
+    static const char* const names[] = { "loader", "first-touch", "interleave" };
+    return ( placement >= LOADER_PLACEMENT && placement < PLACEMENT_COUNT ) ? names[placement] : "unknown";
+}
+
+size_t NumaTopology::getPageSize()
+{
+#ifdef __linux__
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if( pageSize > 0 )
+        return static_cast<size_t>(pageSize);
+#endif
+    return 4096;
+}
+
+int NumaTopology::getNodeCount()
+{
+    // The nodes are numbered from zero, so the last one of the online list gives the count.
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string list;
+    if( !std::getline(online, list) )
+        return 1;
+    const std::vector<int> nodes = parseCpuList(list);
+    return nodes.empty() ? 1 : nodes.back() + 1;
+}
+
+std::vector<int> NumaTopology::getNodeCpus(int node)
+{
+    std::ifstream cpuList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if( std::getline(cpuList, list) )
+        return parseCpuList(list);
+
+    // Without sysfs every processor is on the only node.
+    std::vector<int> cpus;
+    if( node == 0 )
+    {
+#ifdef __linux__
+        const long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+        const long cpuCount = 1;
+#endif
+        for( int cpu = 0; cpu < cpuCount; ++cpu )
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+int NumaTopology::getNodeOfCpu(int cpu)
+{
+    for( int node = 0; node < getNodeCount(); ++node )
+        for( int nodeCpu : getNodeCpus(node) )
+            if( nodeCpu == cpu )
+                return node;
+    return -1;
+}
+
+std::vector<int> NumaTopology::getCompactCpus()
+{
+    std::vector<int> cpus;
+    for( int node = 0; node < getNodeCount(); ++node )
+        for( int cpu : getNodeCpus(node) )
+            cpus.push_back(cpu);
+    return cpus;
+}
+
+std::vector<int> NumaTopology::getScatterCpus()
+{
+    std::vector< std::vector<int> > nodeCpus;
+    size_t longest = 0;
+    for( int node = 0; node < getNodeCount(); ++node )
+    {
+        nodeCpus.push_back( getNodeCpus(node) );
+        longest = std::max( longest, nodeCpus.back().size() );
+    }
+
+    std::vector<int> cpus;
+    for( size_t index = 0; index < longest; ++index )
+        for( const std::vector<int>& node : nodeCpus )
+            if( index < node.size() )
+                cpus.push_back( node[index] );
+    return cpus;
+}
+
+bool NumaTopology::pinCurrentThread(int cpu)
+{
+#ifdef __linux__
+    if( cpu < 0 || cpu >= CPU_SETSIZE )
+        return false;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#else
+    (void) cpu;
+    return false;
+#endif
+}
+
+int NumaTopology::getCurrentCpu()
+{
+#ifdef __linux__
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+bool NumaTopology::interleave(void* address, size_t bytes)
+{
+#ifdef __linux__
+    const int nodeCount = getNodeCount();
+    if( nodeCount < 2 || nodeCount > NUMA_MAXIMUM_NODES )
+        return false;
+
+    // The policy applies to whole pages, so only the pages that lie entirely inside the range are changed.
+    const size_t pageSize = getPageSize();
+    const size_t start = ( reinterpret_cast<size_t>(address) + pageSize - 1 ) / pageSize * pageSize;
+    const size_t finish = ( reinterpret_cast<size_t>(address) + bytes ) / pageSize * pageSize;
+    if( finish <= start )
+        return false;
+
+    const unsigned long nodeMask = nodeCount == NUMA_MAXIMUM_NODES ? ~0UL : (1UL << nodeCount) - 1;
+    return syscall( SYS_mbind, start, finish - start, NUMA_POLICY_INTERLEAVE, &nodeMask, NUMA_MAXIMUM_NODES + 1, 0 ) == 0;
+#else
+    (void) address;
+    (void) bytes;
+    return false;
+#endif
+}
+
+std::vector<size_t> NumaTopology::countPagesPerNode(const std::vector<const void*>& pages)
+{
+    std::vector<size_t> counts( getNodeCount(), 0 );
+#ifdef __linux__
+    // Without target nodes the call moves nothing, and reports the node of every page, or a negative error.
+    std::vector<int> status( pages.size(), -1 );
+    if( !pages.empty() && syscall( SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0 ) == 0 )
+    {
+        for( int node : status )
+            if( node >= 0 && static_cast<size_t>(node) < counts.size() )
+                ++counts[node];
+        return counts;
+    }
+#endif
+    // Without the call every written page is assumed to be on the only node.
+    if( counts.size() == 1 )
+        counts[0] = pages.size();
+    return counts;
+}
@@ -0,0 +1,90 @@
+#ifndef NUMATOPOLOGY_H
+#define NUMATOPOLOGY_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Nodes, processors and page placement of the machine, read from sysfs and queried with the memory policy system
+ * calls, so no NUMA library is needed. On other systems, or when the calls are not allowed, the machine is reported
+ * as a single node and the placement requests do nothing.
+ */
+class NumaTopology
+{
+public:
+    /**
+     * @brief Where the pages of the matrices are placed when a simulation starts.
+     */
+    enum Placement
+    {
+        // Wherever the thread that loaded the file put them, usually all on one node.
+        LOADER_PLACEMENT,
+        // Every worker writes its own tiles first, so their pages land on the node it runs on.
+        FIRST_TOUCH_PLACEMENT,
+        // Pages go round robin over every node, which evens the bandwidth when workers are not pinned.
+        INTERLEAVED_PLACEMENT,
+        PLACEMENT_COUNT
+    };
+
+    /**
+     * @brief Returns a printable name for the given placement.
+     */
+    static const char* getPlacementName(Placement placement);
+
+    /**
+     * @brief Returns the size of a memory page in bytes.
+     */
+    static size_t getPageSize();
+
+    /**
+     * @brief Returns the number of memory nodes of the machine, at least one.
+     */
+    static int getNodeCount();
+
+    /**
+     * @brief Returns the processors of the given node.
+     */
+    static std::vector<int> getNodeCpus(int node);
+
+    /**
+     * @brief Returns the node of the given processor, or -1 if it is unknown.
+     */
+    static int getNodeOfCpu(int cpu);
+
+    /**
+     * @brief Returns every processor, filling a node before moving to the next one, so neighbouring workers share a node.
+     */
+    static std::vector<int> getCompactCpus();
+
+    /**
+     * @brief Returns every processor, taking one of each node in turn, so consecutive workers spread over the nodes.
+     */
+    static std::vector<int> getScatterCpus();
+
+    /**
+     * @brief Restricts the calling thread to the given processor.
+     * @return false if the affinity could not be changed.
+     */
+    static bool pinCurrentThread(int cpu);
+
+    /**
+     * @brief Returns the processor the calling thread is running on, or -1 if it is unknown.
+     */
+    static int getCurrentCpu();
+
+    /**
+     * @brief Spreads the pages of the given range round robin over every node. It only affects pages that were not
+     * written yet.
+     * @return false if the policy could not be set.
+     */
+    static bool interleave(void* address, size_t bytes);
+
+    /**
+     * @brief Counts how many of the given pages are placed on each node. Pages that were never written are not counted.
+     * @param pages Address of every page, each one counted once.
+     * @return The number of pages of each node.
+     */
+    static std::vector<size_t> countPagesPerNode(const std::vector<const void*>& pages);
+};
+
+#endif // NUMATOPOLOGY_H
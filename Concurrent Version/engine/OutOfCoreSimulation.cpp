@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+#include <thread>
+
+#include "BinaryGridFile.h"
+#include "CancellationToken.h"
+#include "GenerationBarrier.h"
+#include "HeatMapWorker.h"
+#include "MappedFile.h"
+#include "OutOfCoreSimulation.h"
+#include "StencilKernel.h"
+#include "TemperatureGrid.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define MADV_WILLNEED 0
+#define MADV_DONTNEED 0
+#endif
+
+OutOfCoreSimulation::OutOfCoreSimulation()
+{
+    this->generations[0] = new TemperatureGrid();
+    this->generations[1] = new TemperatureGrid();
+    this->barrier = new GenerationBarrier();
+    this->cancellationToken = new CancellationToken();
+}
+
+OutOfCoreSimulation::~OutOfCoreSimulation()
+{
+    this->close();
+    delete this->cancellationToken;
+    delete this->barrier;
+    delete this->generations[1];
+    delete this->generations[0];
+}
+
+void OutOfCoreSimulation::setEpsilon(double epsilon)
+{
+    this->epsilon = epsilon;
+}
+
+void OutOfCoreSimulation::setThreadCount(int threadCount)
+{
+    this->threadCount = std::max(threadCount, 0);
+}
+
+void OutOfCoreSimulation::setBandRows(size_t bandRows)
+{
+    this->bandRows = bandRows;
+}
+
+bool OutOfCoreSimulation::open(const std::string& inputPath, const std::string& outputPath)
+{
+    this->close();
+    BinaryGridFile::Layout layout;
+    {
+        MappedFile input;
+        // The cells are not hashed, which would read the whole matrix into memory once more before it is copied.
+        if( !input.open(inputPath) || !BinaryGridFile::inspect(input, layout, false) || layout.dataType != BinaryGridFile::FLOAT64 )
+            return false;
+        this->fileBytes = input.getSize();
+    }
+
+    // Both generations start as copies of the input, so the border, which is never written, is in both.
+    this->outputPath = outputPath;
+    for( int generation = 0; generation < 2; ++generation )
+    {
+        std::error_code error;
+        this->generationPaths[generation] = outputPath + ".generation" + std::to_string(generation);
+        std::filesystem::copy_file(inputPath, this->generationPaths[generation], std::filesystem::copy_options::overwrite_existing, error);
+        if( error || !this->generations[generation]->mapFile(this->generationPaths[generation], layout.rows, layout.columns, layout.stride
+                                                             , layout.firstCellOffset, true) )
+        {
+            this->close();
+            return false;
+        }
+#ifdef __linux__
+        this->descriptors[generation] = ::open(this->generationPaths[generation].c_str(), O_RDWR);
+#endif
+    }
+#ifdef __linux__
+    this->pageSize = static_cast<size_t>( sysconf(_SC_PAGESIZE) );
+#endif
+
+    const TemperatureGrid& matrix = *this->generations[0];
+    this->firstCellOffset = layout.firstCellOffset;
+    this->bandHeight = this->bandRows > 0 ? this->bandRows
+            : std::max( static_cast<size_t>(OUT_OF_CORE_BAND_BYTES) / (matrix.getStride() * sizeof(double)), static_cast<size_t>(1) );
+    this->bandCount = matrix.getInteriorColumns() > 0 ? (matrix.getInteriorRows() + this->bandHeight - 1) / this->bandHeight : 0;
+    this->previousGeneration = 0;
+    this->currentBand = 0;
+    this->releasePending = false;
+    this->generationCount = 0;
+    this->maximumDelta = 0.0;
+    this->equilibriumState = false;
+    this->workerDeltas.clear();
+    return true;
+}
+
+bool OutOfCoreSimulation::run(size_t generations)
+{
+    if( this->generations[0]->empty() )
+        return false;
+    if( this->bandCount == 0 )
+        this->equilibriumState = true;
+    if( this->equilibriumState )
+        return true;
+
+    this->generationLimit = generations > 0 ? this->generationCount + generations : 0;
+    const size_t requestedWorkers = this->threadCount > 0 ? static_cast<size_t>(this->threadCount) : static_cast<size_t>(std::thread::hardware_concurrency());
+    const int workerCount = static_cast<int>( std::max( std::min(requestedWorkers, this->bandHeight), static_cast<size_t>(1) ) );
+
+    // A resumed generation keeps the largest change of the bands it already swept.
+    double sweptDelta = 0.0;
+    for( double delta : this->workerDeltas )
+        sweptDelta = std::max(sweptDelta, delta);
+    this->workerDeltas.assign(workerCount, 0.0);
+    this->workerDeltas[0] = sweptDelta;
+
+    // Only the stops requested while this run is in flight count.
+    this->cancellationToken->begin();
+    this->prefetchBand(this->currentBand, this->previousGeneration);
+    this->barrier->reset(workerCount, [this]() { return this->completeBand(); });
+    std::vector<std::thread> workers;
+    for( int workerId = 1; workerId < workerCount; ++workerId )
+        workers.emplace_back(&OutOfCoreSimulation::work, this, workerId);
+    this->work(0);
+    for( std::thread& worker : workers )
+        worker.join();
+    this->cancellationToken->end();
+    return this->equilibriumState;
+}
+
+void OutOfCoreSimulation::stop()
+{
+    this->cancellationToken->request();
+}
+
+bool OutOfCoreSimulation::save()
+{
+    if( this->generations[0]->empty() )
+        return false;
+
+    // Unmapping leaves every written cell in the file, so the newest generation only needs its checksum.
+    const std::string newestPath = this->generationPaths[this->previousGeneration];
+    for( int generation = 0; generation < 2; ++generation )
+        this->generations[generation]->clear();
+    std::error_code error;
+    const bool saved = BinaryGridFile::seal(newestPath);
+    if( saved )
+        std::filesystem::rename(newestPath, this->outputPath, error);
+    this->close();
+    return saved && !error;
+}
+
+size_t OutOfCoreSimulation::getNumberOfRows() const
+{
+    return this->generations[0]->getNumberOfRows();
+}
+
+size_t OutOfCoreSimulation::getNumberOfColumns() const
+{
+    return this->generations[0]->getNumberOfColumns();
+}
+
+size_t OutOfCoreSimulation::getGenerationCount() const
+{
+    return this->generationCount;
+}
+
+double OutOfCoreSimulation::getMaximumDelta() const
+{
+    return this->maximumDelta;
+}
+
+size_t OutOfCoreSimulation::getBandRows() const
+{
+    return this->bandHeight;
+}
+
+size_t OutOfCoreSimulation::getWindowBytes() const
+{
+    return 2 * OUT_OF_CORE_WINDOW_BANDS * this->bandHeight * this->generations[0]->getStride() * sizeof(double);
+}
+
+void OutOfCoreSimulation::close()
+{
+    for( int generation = 0; generation < 2; ++generation )
+    {
+        this->generations[generation]->clear();
+#ifdef __linux__
+        if( this->descriptors[generation] >= 0 )
+            ::close(this->descriptors[generation]);
+#endif
+        this->descriptors[generation] = -1;
+        if( !this->generationPaths[generation].empty() )
+        {
+            std::error_code error;
+            std::filesystem::remove(this->generationPaths[generation], error);
+            this->generationPaths[generation].clear();
+        }
+    }
+    this->bandCount = 0;
+}
+
+void OutOfCoreSimulation::work(int workerId)
+{
+    const int workerCount = static_cast<int>( this->workerDeltas.size() );
+    do
+    {
+        // The barrier publishes the band and the generations chosen by completeBand() to every worker.
+        const TemperatureGrid& previous = *this->generations[this->previousGeneration];
+        TemperatureGrid& current = *this->generations[1 - this->previousGeneration];
+        size_t bandStart = 0;
+        size_t bandFinish = 0;
+        this->getBandInterval(this->currentBand, bandStart, bandFinish);
+        const size_t startRow = bandStart + HeatMapWorker::calculateStart(bandFinish - bandStart, workerCount, workerId);
+        const size_t finishRow = bandStart + HeatMapWorker::calculateFinish(bandFinish - bandStart, workerCount, workerId);
+        if( finishRow > startRow )
+        {
+            const double delta = StencilKernel::sweep( previous.interior(startRow), current.interior(startRow), previous.getStride()
+                                                     , finishRow - startRow, previous.getInteriorColumns() );
+            this->workerDeltas[workerId] = std::max(this->workerDeltas[workerId], delta);
+        }
+    }
+    while( this->barrier->arriveAndWait() );
+}
+
+bool OutOfCoreSimulation::completeBand()
+{
+    // The band swept before is written back by now, so its pages can be dropped, and the one just swept starts
+    // being written back while the next one is swept.
+    if( this->releasePending )
+        this->releaseBand(this->releasedBand, this->releasedGeneration);
+    this->writeBackBand(this->currentBand, this->previousGeneration);
+    this->releasePending = true;
+    this->releasedBand = this->currentBand;
+    this->releasedGeneration = this->previousGeneration;
+
+    if( ++this->currentBand == this->bandCount )
+    {
+        this->currentBand = 0;
+        ++this->generationCount;
+        this->previousGeneration = 1 - this->previousGeneration;
+        this->maximumDelta = 0.0;
+        for( double& delta : this->workerDeltas )
+        {
+            this->maximumDelta = std::max(this->maximumDelta, delta);
+            delta = 0.0;
+        }
+        if( this->maximumDelta <= this->epsilon )
+        {
+            this->equilibriumState = true;
+            return false;
+        }
+        if( this->generationLimit > 0 && this->generationCount >= this->generationLimit )
+            return false;
+    }
+    if( this->cancellationToken->isRequested() )
+        return false;
+
+    // The next band was read ahead while this one was swept, so the one after it is read ahead now.
+    if( this->currentBand + 1 < this->bandCount )
+        this->prefetchBand(this->currentBand + 1, this->previousGeneration);
+    else
+        this->prefetchBand(0, 1 - this->previousGeneration);
+    return true;
+}
+
+void OutOfCoreSimulation::getBandInterval(size_t band, size_t& startRow, size_t& finishRow) const
+{
+    startRow = band * this->bandHeight;
+    finishRow = std::min( startRow + this->bandHeight, this->generations[0]->getInteriorRows() );
+}
+
+void OutOfCoreSimulation::prefetchBand(size_t band, int previousGeneration)
+{
+    // Interior row i is row i + 1 of the grid, and its stencil reads the rows above and below it.
+    size_t startRow = 0;
+    size_t finishRow = 0;
+    this->getBandInterval(band, startRow, finishRow);
+    this->adviseRows(previousGeneration, startRow, finishRow - startRow + 2, MADV_WILLNEED, true);
+    this->adviseRows(1 - previousGeneration, startRow + 1, finishRow - startRow, MADV_WILLNEED, true);
+}
+
+void OutOfCoreSimulation::writeBackBand(size_t band, int previousGeneration)
+{
+#ifdef __linux__
+    size_t startRow = 0;
+    size_t finishRow = 0;
+    this->getBandInterval(band, startRow, finishRow);
+    const size_t startOffset = this->getRowOffset(startRow + 1);
+    sync_file_range( this->descriptors[1 - previousGeneration], static_cast<off_t>(startOffset)
+                   , static_cast<off_t>( this->getRowOffset(finishRow + 1) - startOffset ), SYNC_FILE_RANGE_WRITE );
+#else
+    (void) band; (void) previousGeneration;
+#endif
+}
+
+void OutOfCoreSimulation::releaseBand(size_t band, int previousGeneration)
+{
+    // The last two rows read by the band are read by the next one too.
+    size_t startRow = 0;
+    size_t finishRow = 0;
+    this->getBandInterval(band, startRow, finishRow);
+    this->adviseRows(previousGeneration, startRow, finishRow - startRow, MADV_DONTNEED, false);
+    this->adviseRows(1 - previousGeneration, startRow + 1, finishRow - startRow, MADV_DONTNEED, false);
+}
+
+size_t OutOfCoreSimulation::getRowOffset(size_t row) const
+{
+    const TemperatureGrid& matrix = *this->generations[0];
+    if( row >= matrix.getNumberOfRows() )
+        return this->firstCellOffset + ( (matrix.getNumberOfRows() - 1) * matrix.getStride() + matrix.getNumberOfColumns() ) * sizeof(double);
+    return this->firstCellOffset + row * matrix.getStride() * sizeof(double);
+}
+
+void OutOfCoreSimulation::adviseRows(int generation, size_t firstRow, size_t rowCount, int advice, bool roundOutwards) const
+{
+#ifdef __linux__
+    const size_t firstOffset = this->getRowOffset(firstRow);
+    const size_t lastOffset = this->getRowOffset(firstRow + rowCount);
+    const size_t startOffset = (roundOutwards ? firstOffset : firstOffset + this->pageSize - 1) / this->pageSize * this->pageSize;
+    const size_t finishOffset = (roundOutwards ? lastOffset + this->pageSize - 1 : lastOffset) / this->pageSize * this->pageSize;
+    if( finishOffset <= startOffset )
+        return;
+
+    // The mapping starts on a page boundary, at the start of the file.
+    char* mapping = reinterpret_cast<char*>( this->generations[generation]->row(0) ) - this->firstCellOffset;
+    const size_t bytes = std::min(finishOffset, this->fileBytes) - startOffset;
+    madvise(mapping + startOffset, bytes, advice);
+    // Dropping the pages from the mapping keeps them in the page cache, so the clean ones are evicted from it too.
+    if( advice == MADV_DONTNEED )
+        posix_fadvise( this->descriptors[generation], static_cast<off_t>(startOffset), static_cast<off_t>(bytes), POSIX_FADV_DONTNEED );
+#else
+    (void) generation; (void) firstRow; (void) rowCount; (void) advice; (void) roundOutwards;
+#endif
+}
@@ -0,0 +1,187 @@
+#ifndef OUTOFCORESIMULATION_H
+#define OUTOFCORESIMULATION_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Bytes of the rows of a band when no band height is set.
+#define OUT_OF_CORE_BAND_BYTES (32 << 20)
+// Bands of each generation kept in memory: the one written back, the one swept and the one read ahead.
+#define OUT_OF_CORE_WINDOW_BANDS 3
+
+class CancellationToken;
+class GenerationBarrier;
+class TemperatureGrid;
+
+/**
+ * Jacobi simulation of a matrix that does not fit in memory. Both generations are kept in scratch copies of a binary
+ * grid file, mapped shared, and the interior is swept one band of rows after another by a pool of workers. The
+ * memory in use is a sliding window of bands: while a band is swept, the system reads the next one ahead, and writes
+ * back the one swept before, whose pages are then dropped. Every other page is only in the files, so the matrix can
+ * be several times larger than the memory, and the result is the same as the one of the in-memory Jacobi solver.
+ */
+class OutOfCoreSimulation
+{
+private:
+    std::string outputPath;
+    std::string generationPaths[2];
+    int descriptors[2] = { -1, -1 };
+    TemperatureGrid * generations[2] = { nullptr, nullptr };
+    // Index of the generation read by the sweep, the other one is written.
+    int previousGeneration = 0;
+    size_t firstCellOffset = 0;
+    size_t fileBytes = 0;
+    size_t pageSize = 4096;
+
+    double epsilon = 0.0;
+    int threadCount = 0;
+    size_t bandRows = 0;
+    size_t bandHeight = 0;
+    size_t bandCount = 0;
+    size_t currentBand = 0;
+    // Band swept before the current one, dropped once the current one is swept.
+    bool releasePending = false;
+    size_t releasedBand = 0;
+    int releasedGeneration = 0;
+
+    size_t generationCount = 0;
+    size_t generationLimit = 0;
+    double maximumDelta = 0.0;
+    bool equilibriumState = false;
+    std::vector<double> workerDeltas;
+    GenerationBarrier * barrier = nullptr;
+    CancellationToken * cancellationToken = nullptr;
+
+public:
+    OutOfCoreSimulation();
+    OutOfCoreSimulation(const OutOfCoreSimulation&) = delete;
+    OutOfCoreSimulation& operator=(const OutOfCoreSimulation&) = delete;
+    ~OutOfCoreSimulation();
+
+    /**
+     * @brief Sets the largest change of a cell in a generation once the equilibrium state is reached.
+     */
+    void setEpsilon(double epsilon);
+
+    /**
+     * @brief Sets the number of workers that sweep every band, or zero for one per hardware thread.
+     */
+    void setThreadCount(int threadCount);
+
+    /**
+     * @brief Sets the number of rows of a band, or zero to size them by OUT_OF_CORE_BAND_BYTES. It takes effect on the
+     * next call to open().
+     */
+    void setBandRows(size_t bandRows);
+
+    /**
+     * @brief Copies a binary grid file of double precision cells into two scratch files next to the output file,
+     * one per generation, and maps them. The scratch files are removed by save() or when the simulation is destroyed.
+     * @return false if the input is not a valid binary grid file, or the scratch files could not be written.
+     */
+    bool open(const std::string& inputPath, const std::string& outputPath);
+
+    /**
+     * @brief Simulates until the equilibrium state is reached, the generation limit is reached or stop() is called.
+     * A stopped simulation is resumed from the band where it stopped.
+     * @param generations Maximum number of generations of this call, or zero for no limit.
+     * @return true if the equilibrium state was reached.
+     */
+    bool run(size_t generations = 0);
+
+    /**
+     * @brief Makes run() return once the band being swept is finished. It can be called from any thread, and is
+     * dropped when run() is not in flight, so it does not stop the next call.
+     */
+    void stop();
+
+    /**
+     * @brief Writes the last completed generation to the output file, without copying it, and removes the other
+     * scratch file. The simulation must be opened again afterwards.
+     * @return false if the output file could not be written.
+     */
+    bool save();
+
+    /**
+     * @brief Returns the number of rows of the opened matrix, border included.
+     */
+    size_t getNumberOfRows() const;
+
+    /**
+     * @brief Returns the number of columns of the opened matrix, border included.
+     */
+    size_t getNumberOfColumns() const;
+
+    /**
+     * @brief Returns the number of completed generations.
+     */
+    size_t getGenerationCount() const;
+
+    /**
+     * @brief Returns the largest change of a cell in the last completed generation.
+     */
+    double getMaximumDelta() const;
+
+    /**
+     * @brief Returns the number of rows of a band.
+     */
+    size_t getBandRows() const;
+
+    /**
+     * @brief Returns the bytes of both generations kept in memory by the sliding window.
+     */
+    size_t getWindowBytes() const;
+
+private:
+    /**
+     * @brief Unmaps and removes the scratch files.
+     */
+    void close();
+
+    /**
+     * @brief Sweeps the share of the given worker of the current band, as many times as there are bands to sweep.
+     */
+    void work(int workerId);
+
+    /**
+     * @brief Run by the last worker to finish a band: moves the window to the next band and ends the generation
+     * after the last one.
+     * @return false when the workers must stop.
+     */
+    bool completeBand();
+
+    /**
+     * @brief Returns the interior rows of the given band, as its first row and the row after its last one.
+     */
+    void getBandInterval(size_t band, size_t& startRow, size_t& finishRow) const;
+
+    /**
+     * @brief Asks the system to read the rows a band reads and writes, in the background.
+     * @param previousGeneration Index of the generation the band reads.
+     */
+    void prefetchBand(size_t band, int previousGeneration);
+
+    /**
+     * @brief Starts writing the rows written by a band to their file, in the background.
+     */
+    void writeBackBand(size_t band, int previousGeneration);
+
+    /**
+     * @brief Drops the pages of the rows a band read and wrote from memory. Their cells stay in the files.
+     */
+    void releaseBand(size_t band, int previousGeneration);
+
+    /**
+     * @brief Returns the offset in the file of the first cell of the given row, or the end of the cells.
+     */
+    size_t getRowOffset(size_t row) const;
+
+    /**
+     * @brief Gives the system the given advice about the pages of some rows of a generation.
+     * @param roundOutwards Include the pages the rows only partially cover.
+     */
+    void adviseRows(int generation, size_t firstRow, size_t rowCount, int advice, bool roundOutwards) const;
+};
+
+#endif // OUTOFCORESIMULATION_H
@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <cmath>
+
+#include "RelaxationEstimator.h"
+
+RelaxationEstimator::RelaxationEstimator()
+{}
+
+double RelaxationEstimator::getOptimalFactor(size_t interiorRows, size_t interiorColumns)
+{
+    if( interiorRows == 0 || interiorColumns == 0 )
+        return 1.0;
+
+    // Spectral radius of the Jacobi iteration for the five point stencil on this rectangle.
+    const double pi = std::acos(-1.0);
+    const double jacobiRadius = ( std::cos(pi / (interiorRows + 1)) + std::cos(pi / (interiorColumns + 1)) ) / 2.0;
+    return 2.0 / ( 1.0 + std::sqrt(1.0 - jacobiRadius * jacobiRadius) );
+}
+
+void RelaxationEstimator::reset(double relaxationFactor, double maximumFactor)
+{
+    this->relaxationFactor = relaxationFactor;
+    this->maximumFactor = std::max(relaxationFactor, maximumFactor);
+    this->previousDelta = 0.0;
+    this->previousRate = 0.0;
+    this->stableGenerations = 0;
+}
+
+double RelaxationEstimator::getRelaxationFactor() const
+{
+    return this->relaxationFactor;
+}
+
+double RelaxationEstimator::update(double maximumDelta)
+{
+    if( this->previousDelta > 0.0 && maximumDelta > 0.0 )
+    {
+        const double rate = maximumDelta / this->previousDelta;
+        if( rate < 1.0 && std::fabs(rate - this->previousRate) < RELAXATION_RATE_TOLERANCE * rate )
+            ++this->stableGenerations;
+        else
+            this->stableGenerations = 0;
+        this->previousRate = rate;
+
+        if( this->stableGenerations >= RELAXATION_STABLE_GENERATIONS )
+        {
+            // While the factor is below the optimal one, the SOR rate and the Jacobi radius are related by
+            // (rate + factor - 1)^2 = rate * factor^2 * radius^2, so the radius can be recovered from the rate.
+            const double factor = this->relaxationFactor;
+            const double jacobiRadius = std::min( (rate + factor - 1.0) / (factor * std::sqrt(rate)), 1.0 );
+            const double estimate = std::min( 2.0 / ( 1.0 + std::sqrt(1.0 - jacobiRadius * jacobiRadius) ), this->maximumFactor );
+
+            // An estimate can only be trusted while it is below the optimal factor, so the factor only grows.
+            if( estimate > this->relaxationFactor )
+                this->relaxationFactor = estimate;
+            this->stableGenerations = 0;
+        }
+    }
+    this->previousDelta = maximumDelta;
+    return this->relaxationFactor;
+}
@@ -0,0 +1,57 @@
+#ifndef RELAXATIONESTIMATOR_H
+#define RELAXATIONESTIMATOR_H
+
+#include <cstddef>
+
+// Consecutive generations whose convergence rate must agree before the adaptive factor is updated.
+#define RELAXATION_STABLE_GENERATIONS 5
+// Relative difference below which two convergence rates are considered to agree.
+#define RELAXATION_RATE_TOLERANCE 0.01
+
+/**
+ * Chooses the relaxation factor of the SOR solver. For a rectangle with a fixed border the optimal factor
+ * is known from its dimensions, and lowers the generations needed from O(N^2) to O(N). In adaptive mode the
+ * solver starts as Gauss-Seidel, and the factor is raised from the rate at which the maximum change of a
+ * generation decreases. While heat is still spreading from the border that rate is close to one without being
+ * asymptotic yet, so the estimates are bounded by a maximum factor, usually the optimal one of the rectangle.
+ */
+class RelaxationEstimator
+{
+private:
+    double relaxationFactor = 1.0;
+    double maximumFactor = 1.0;
+    double previousDelta = 0.0;
+    double previousRate = 0.0;
+    size_t stableGenerations = 0;
+
+public:
+    RelaxationEstimator();
+
+    /**
+      * @brief Returns the optimal SOR factor for the Laplace equation on a rectangle with a fixed border.
+      * @param interiorRows Number of rows that are updated.
+      * @param interiorColumns Number of columns that are updated.
+      */
+    static double getOptimalFactor(size_t interiorRows, size_t interiorColumns);
+
+    /**
+      * @brief Forgets the observed generations and starts again from the given factor.
+      * @param relaxationFactor Factor used until the convergence rate is known.
+      * @param maximumFactor Largest factor update() may choose.
+      */
+    void reset(double relaxationFactor, double maximumFactor);
+
+    /**
+      * @brief Returns the factor to use in the next generation.
+      */
+    double getRelaxationFactor() const;
+
+    /**
+      * @brief Records the maximum change of a generation, and raises the factor once the convergence rate is stable.
+      * @param maximumDelta Maximum absolute difference between a temperature and the value it replaced.
+      * @return The factor to use in the next generation.
+      */
+    double update(double maximumDelta);
+};
+
+#endif // RELAXATIONESTIMATOR_H
@@ -0,0 +1,141 @@
+#include <cmath>
+
+#include "SineTransform.h"
+
+// std::complex multiplication checks for infinities and NaNs through a library call, which dominates the butterflies.
+static inline std::complex<double> multiply(const std::complex<double>& left, const std::complex<double>& right)
+{
+    return std::complex<double>( left.real() * right.real() - left.imag() * right.imag()
+                               , left.real() * right.imag() + left.imag() * right.real() );
+}
+
+SineTransform::SineTransform(size_t length)
+{
+    this->resize(length);
+}
+
+void SineTransform::resize(size_t length)
+{
+    this->length = length;
+    // The odd extension 0, x, 0, -reversed x has a purely imaginary Fourier transform made of the sine transform.
+    this->extendedLength = 2 * (length + 1);
+    this->useBluestein = (this->extendedLength & (this->extendedLength - 1)) != 0;
+
+    // Bluestein's algorithm turns the transform into a circular convolution, which needs room for 2 * N - 1 values.
+    const size_t minimumLength = this->useBluestein ? 2 * this->extendedLength - 1 : this->extendedLength;
+    this->fourierLength = 1;
+    while( this->fourierLength < minimumLength )
+        this->fourierLength *= 2;
+
+    const double pi = std::acos(-1.0);
+    this->twiddles.resize(this->fourierLength / 2);
+    for( size_t index = 0; index < this->twiddles.size(); ++index )
+        this->twiddles[index] = std::polar(1.0, -2.0 * pi * index / this->fourierLength);
+
+    this->buffer.assign(this->fourierLength, Complex());
+    this->chirp.clear();
+    this->chirpFilter.clear();
+    if( !this->useBluestein )
+        return;
+
+    // chirp[n] = exp(-i pi n^2 / N). The square is reduced modulo 2N first, so the angle stays small and exact.
+    this->chirp.resize(this->extendedLength);
+    for( size_t index = 0; index < this->extendedLength; ++index )
+    {
+        const size_t square = (index * index) % (2 * this->extendedLength);
+        this->chirp[index] = std::polar(1.0, -pi * square / this->extendedLength);
+    }
+    this->chirpFilter.assign(this->fourierLength, Complex());
+    this->chirpFilter[0] = std::conj(this->chirp[0]);
+    for( size_t index = 1; index < this->extendedLength; ++index )
+        this->chirpFilter[index] = this->chirpFilter[this->fourierLength - index] = std::conj(this->chirp[index]);
+    this->transformPowerOfTwo(this->chirpFilter);
+}
+
+size_t SineTransform::getLength() const
+{
+    return this->length;
+}
+
+void SineTransform::transform(double* values)
+{
+    this->transform(values, nullptr);
+}
+
+void SineTransform::transform(double* first, double* second)
+{
+    if( this->length == 0 )
+        return;
+
+    this->buffer[0] = this->buffer[this->length + 1] = Complex();
+    for( size_t index = 0; index < this->length; ++index )
+    {
+        const Complex value( first[index], second ? second[index] : 0.0 );
+        this->buffer[index + 1] = value;
+        this->buffer[this->extendedLength - 1 - index] = -value;
+    }
+    this->transformExtended();
+
+    // The transform of an odd real sequence is -2i times its sine transform, so the one in the imaginary
+    // part turns real and both can be told apart.
+    for( size_t index = 0; index < this->length; ++index )
+    {
+        first[index] = -0.5 * this->buffer[index + 1].imag();
+        if( second )
+            second[index] = 0.5 * this->buffer[index + 1].real();
+    }
+}
+
+void SineTransform::transformPowerOfTwo(std::vector<Complex>& data) const
+{
+    const size_t count = this->fourierLength;
+
+    for( size_t index = 1, reversed = 0; index < count; ++index )
+    {
+        size_t bit = count >> 1;
+        for( ; reversed & bit; bit >>= 1 )
+            reversed ^= bit;
+        reversed ^= bit;
+        if( index < reversed )
+            std::swap(data[index], data[reversed]);
+    }
+
+    for( size_t half = 1; half < count; half *= 2 )
+    {
+        const size_t step = count / (2 * half);
+        for( size_t start = 0; start < count; start += 2 * half )
+        {
+            for( size_t offset = 0; offset < half; ++offset )
+            {
+                const Complex odd = multiply( data[start + offset + half], this->twiddles[offset * step] );
+                data[start + offset + half] = data[start + offset] - odd;
+                data[start + offset] += odd;
+            }
+        }
+    }
+}
+
+void SineTransform::transformExtended()
+{
+    if( !this->useBluestein )
+    {
+        this->transformPowerOfTwo(this->buffer);
+        return;
+    }
+
+    // X[k] = chirp[k] * sum of (x[n] * chirp[n]) * conj(chirp[k - n]), a convolution computed with three transforms.
+    for( size_t index = 0; index < this->extendedLength; ++index )
+        this->buffer[index] = multiply( this->buffer[index], this->chirp[index] );
+    for( size_t index = this->extendedLength; index < this->fourierLength; ++index )
+        this->buffer[index] = Complex();
+
+    this->transformPowerOfTwo(this->buffer);
+    for( size_t index = 0; index < this->fourierLength; ++index )
+        this->buffer[index] = std::conj( multiply(this->buffer[index], this->chirpFilter[index]) );
+    // The inverse transform is the conjugate of the forward transform of the conjugate.
+    this->transformPowerOfTwo(this->buffer);
+
+    const double scale = 1.0 / this->fourierLength;
+    for( size_t index = 0; index < this->extendedLength; ++index )
+        this->buffer[index] = multiply( std::conj(this->buffer[index]) * scale, this->chirp[index] );
+}
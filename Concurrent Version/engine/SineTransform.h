@@ -0,0 +1,66 @@
+#ifndef SINETRANSFORM_H
+#define SINETRANSFORM_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Discrete sine transform of type I, computed through a fast Fourier transform of its odd extension.
+ * The Fourier transform is radix-2, and lengths that are not a power of two are handled with Bluestein's
+ * algorithm, so every length costs O(N log N). The transform is its own inverse up to a factor 2 / (N + 1).
+ */
+class SineTransform
+{
+private:
+    typedef std::complex<double> Complex;
+
+    size_t length = 0;
+    size_t extendedLength = 0;
+    size_t fourierLength = 0;
+    bool useBluestein = false;
+
+    std::vector<Complex> twiddles;
+    std::vector<Complex> chirp;
+    std::vector<Complex> chirpFilter;
+    std::vector<Complex> buffer;
+
+public:
+    explicit SineTransform(size_t length = 0);
+
+    /**
+     * @brief Prepares the twiddle factors for sequences of the given length.
+     */
+    void resize(size_t length);
+
+    /**
+     * @brief Returns the length of the sequences the transform is prepared for.
+     */
+    size_t getLength() const;
+
+    /**
+     * @brief Replaces the sequence with X[k] = sum of x[n] * sin(pi * (n + 1) * (k + 1) / (length + 1)).
+     * @param values Sequence of getLength() values.
+     */
+    void transform(double* values);
+
+    /**
+     * @brief Transforms two sequences with a single Fourier transform, one in its real part and one in its imaginary part.
+     * @param first Sequence of getLength() values.
+     * @param second Sequence of getLength() values, or nullptr to transform only the first one.
+     */
+    void transform(double* first, double* second);
+
+private:
+    /**
+     * @brief Computes in place the forward Fourier transform of the first fourierLength values of data.
+     */
+    void transformPowerOfTwo(std::vector<Complex>& data) const;
+
+    /**
+     * @brief Computes in place the forward Fourier transform of the first extendedLength values of the buffer.
+     */
+    void transformExtended();
+};
+
+#endif // SINETRANSFORM_H
@@ -0,0 +1,39 @@
+#include "SnapshotBuffer.h"
+
+// Set in the middle index when it holds a snapshot the reader has not taken.
+#define SNAPSHOT_FRESH 4
+#define SNAPSHOT_INDEX_MASK 3
+
+SnapshotBuffer::SnapshotBuffer()
+    : middle(2)
+{}
+
+bool SnapshotBuffer::isWanted() const
+{
+    return ( this->middle.load(std::memory_order_relaxed) & SNAPSHOT_FRESH ) == 0;
+}
+
+void SnapshotBuffer::publish(const TemperatureGrid& matrix, size_t generation)
+{
+    Snapshot& snapshot = this->reserve();
+    snapshot.matrix.assign(matrix);
+    snapshot.generation = generation;
+    this->commit();
+}
+
+SnapshotBuffer::Snapshot& SnapshotBuffer::reserve()
+{
+    return this->snapshots[this->back];
+}
+
+void SnapshotBuffer::commit()
+{
+    this->back = this->middle.exchange(this->back | SNAPSHOT_FRESH, std::memory_order_acq_rel) & SNAPSHOT_INDEX_MASK;
+}
+
+const SnapshotBuffer::Snapshot& SnapshotBuffer::acquire()
+{
+    if( this->middle.load(std::memory_order_relaxed) & SNAPSHOT_FRESH )
+        this->front = this->middle.exchange(this->front, std::memory_order_acq_rel) & SNAPSHOT_INDEX_MASK;
+    return this->snapshots[this->front];
+}
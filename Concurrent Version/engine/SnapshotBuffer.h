@@ -0,0 +1,71 @@
+#ifndef SNAPSHOTBUFFER_H
+#define SNAPSHOTBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+
+#include "TemperatureGrid.h"
+
+/**
+ * Lock-free triple buffer that hands completed generations from the simulation to one consumer, such as the
+ * window that paints them. The writer fills its own slot and exchanges it with the middle one, and the reader
+ * exchanges its slot with the middle one when a newer snapshot is there, so neither of them ever waits for the
+ * other or sees a matrix that is being written. Snapshots are copied only when the consumer took the previous
+ * one, so a slow consumer costs the simulation at most one copy per frame it shows. The writer may fill its slot
+ * itself, from several threads, between reserve() and commit().
+ */
+class SnapshotBuffer
+{
+public:
+    /**
+     * @brief A copy of the matrix as it was after a generation.
+     */
+    struct Snapshot
+    {
+        TemperatureGrid matrix;
+        size_t generation = 0;
+    };
+
+private:
+    Snapshot snapshots[3];
+    // Index of the slot between the writer and the reader, plus a flag when the reader did not take it yet.
+    std::atomic<int> middle;
+    // Only the writer touches its slot, and only the reader touches its own.
+    int back = 0;
+    int front = 1;
+
+public:
+    SnapshotBuffer();
+
+    /**
+     * @brief Returns true when the consumer took the last snapshot, so a new one would be seen.
+     */
+    bool isWanted() const;
+
+    /**
+     * @brief Copies the matrix into the slot of the writer and makes it the newest snapshot. Only one thread may
+     * publish at a time.
+     * @param matrix Matrix with a completed generation.
+     * @param generation Number of the generation.
+     */
+    void publish(const TemperatureGrid& matrix, size_t generation);
+
+    /**
+     * @brief Returns the slot of the writer, to be filled before commit() makes it the newest snapshot. It is only
+     * touched by the writer, and reserving it again drops what was filled.
+     */
+    Snapshot& reserve();
+
+    /**
+     * @brief Makes the slot returned by reserve() the newest snapshot.
+     */
+    void commit();
+
+    /**
+     * @brief Returns the newest snapshot published. It stays valid and unchanged until the next call, which only
+     * the consumer may make. Its matrix is empty if nothing was published yet.
+     */
+    const Snapshot& acquire();
+};
+
+#endif // SNAPSHOTBUFFER_H
@@ -0,0 +1,253 @@
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "SocketTransport.h"
+
+#ifdef __unix__
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// A peer that is gone must fail the call, not kill the process with SIGPIPE.
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+// Milliseconds between two attempts to connect to a peer that is not listening yet.
+#define SOCKET_RETRY_MILLISECONDS 10
+
+#ifdef __unix__
+static bool makeAddress(const std::string& path, sockaddr_un& address)
+{
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if( path.size() >= sizeof(address.sun_path) )
+        return false;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+static bool sendAll(int peerSocket, const char* data, size_t bytes)
+{
+    while( bytes > 0 )
+    {
+        const ssize_t written = ::send(peerSocket, data, bytes, MSG_NOSIGNAL);
+        if( written < 0 && errno == EINTR )
+            continue;
+        if( written <= 0 )
+            return false;
+        data += written;
+        bytes -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+static bool receiveAll(int peerSocket, char* data, size_t bytes)
+{
+    while( bytes > 0 )
+    {
+        const ssize_t read = ::recv(peerSocket, data, bytes, 0);
+        if( read < 0 && errno == EINTR )
+            continue;
+        // Zero bytes means the peer closed the connection.
+        if( read <= 0 )
+            return false;
+        data += read;
+        bytes -= static_cast<size_t>(read);
+    }
+    return true;
+}
+#endif
+
+SocketTransport::SocketTransport(const std::string& socketPrefix, int rank, int processCount)
+    : socketPrefix(socketPrefix)
+    , rank(rank)
+    , processCount(processCount)
+    , peerSockets(processCount, -1)
+{
+}
+
+SocketTransport::~SocketTransport()
+{
+    this->disconnect();
+}
+
+bool SocketTransport::connect(double timeoutSeconds)
+{
+#ifdef __unix__
+    this->disconnect();
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+            + std::chrono::duration_cast<std::chrono::steady_clock::duration>( std::chrono::duration<double>(timeoutSeconds) );
+
+    // Only the processes of higher rank connect to this one, so the last one does not listen.
+    const std::string listenerPath = this->getSocketPath(this->rank);
+    int listener = -1;
+    bool connected = true;
+    if( this->rank + 1 < this->processCount )
+    {
+        sockaddr_un address;
+        listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        // A process that crashed may have left its socket behind.
+        ::unlink( listenerPath.c_str() );
+        connected = listener >= 0 && makeAddress(listenerPath, address)
+                && ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0
+                && ::listen(listener, this->processCount) == 0;
+    }
+
+    for( int peer = 0; connected && peer < this->rank; ++peer )
+    {
+        sockaddr_un address;
+        connected = makeAddress(this->getSocketPath(peer), address);
+        while( connected )
+        {
+            const int peerSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if( peerSocket < 0 )
+                connected = false;
+            else if( ::connect(peerSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 )
+            {
+                // The peer accepts the connections in any order, so the first message tells it who connected.
+                this->peerSockets[peer] = peerSocket;
+                connected = sendAll( peerSocket, reinterpret_cast<const char*>(&this->rank), sizeof(this->rank) );
+                break;
+            }
+            else
+            {
+                ::close(peerSocket);
+                if( std::chrono::steady_clock::now() >= deadline )
+                    connected = false;
+                else
+                    std::this_thread::sleep_for( std::chrono::milliseconds(SOCKET_RETRY_MILLISECONDS) );
+            }
+        }
+    }
+
+    for( int acceptedCount = this->rank + 1; connected && acceptedCount < this->processCount; ++acceptedCount )
+    {
+        const long long remaining = std::chrono::duration_cast<std::chrono::milliseconds>( deadline - std::chrono::steady_clock::now() ).count();
+        pollfd descriptor = { listener, POLLIN, 0 };
+        const int peerSocket = remaining > 0 && ::poll(&descriptor, 1, static_cast<int>(remaining)) > 0 ? ::accept(listener, nullptr, nullptr) : -1;
+        int peer = -1;
+        if( peerSocket >= 0 && receiveAll( peerSocket, reinterpret_cast<char*>(&peer), sizeof(peer) )
+                && peer > this->rank && peer < this->processCount && this->peerSockets[peer] < 0 )
+            this->peerSockets[peer] = peerSocket;
+        else
+        {
+            if( peerSocket >= 0 )
+                ::close(peerSocket);
+            connected = false;
+        }
+    }
+
+    if( listener >= 0 )
+    {
+        ::close(listener);
+        ::unlink( listenerPath.c_str() );
+    }
+    if( !connected )
+        this->disconnect();
+    return connected;
+#else
+    (void) timeoutSeconds;
+    return this->processCount == 1;
+#endif
+}
+
+int SocketTransport::getRank() const
+{
+    return this->rank;
+}
+
+int SocketTransport::getProcessCount() const
+{
+    return this->processCount;
+}
+
+bool SocketTransport::send(int peer, const void* data, size_t bytes)
+{
+#ifdef __unix__
+    return this->peerSockets[peer] >= 0 && sendAll( this->peerSockets[peer], static_cast<const char*>(data), bytes );
+#else
+    (void) peer; (void) data; (void) bytes;
+    return false;
+#endif
+}
+
+bool SocketTransport::receive(int peer, void* data, size_t bytes)
+{
+#ifdef __unix__
+    return this->peerSockets[peer] >= 0 && receiveAll( this->peerSockets[peer], static_cast<char*>(data), bytes );
+#else
+    (void) peer; (void) data; (void) bytes;
+    return false;
+#endif
+}
+
+bool SocketTransport::exchange(int peer, const void* sent, void* received, size_t bytes)
+{
+#ifdef __unix__
+    const int peerSocket = this->peerSockets[peer];
+    if( peerSocket < 0 )
+        return false;
+
+    // Sending all first could fill the buffers of both sockets while both peers wait for the other one to read,
+    // so each end writes and reads whatever the socket takes until both messages are through.
+    const char* sentCursor = static_cast<const char*>(sent);
+    char* receivedCursor = static_cast<char*>(received);
+    size_t sentBytes = 0;
+    size_t receivedBytes = 0;
+    while( sentBytes < bytes || receivedBytes < bytes )
+    {
+        pollfd descriptor = { peerSocket, static_cast<short>( (sentBytes < bytes ? POLLOUT : 0) | (receivedBytes < bytes ? POLLIN : 0) ), 0 };
+        if( ::poll(&descriptor, 1, -1) < 0 )
+        {
+            if( errno == EINTR )
+                continue;
+            return false;
+        }
+        if( descriptor.revents & (POLLERR | POLLNVAL) )
+            return false;
+
+        if( sentBytes < bytes && (descriptor.revents & POLLOUT) )
+        {
+            const ssize_t written = ::send(peerSocket, sentCursor + sentBytes, bytes - sentBytes, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if( written < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR )
+                return false;
+            if( written > 0 )
+                sentBytes += static_cast<size_t>(written);
+        }
+        if( receivedBytes < bytes && (descriptor.revents & (POLLIN | POLLHUP)) )
+        {
+            const ssize_t read = ::recv(peerSocket, receivedCursor + receivedBytes, bytes - receivedBytes, MSG_DONTWAIT);
+            if( read == 0 || (read < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) )
+                return false;
+            if( read > 0 )
+                receivedBytes += static_cast<size_t>(read);
+        }
+    }
+    return true;
+#else
+    (void) peer; (void) sent; (void) received; (void) bytes;
+    return false;
+#endif
+}
+
+std::string SocketTransport::getSocketPath(int peerRank) const
+{
+    return this->socketPrefix + "." + std::to_string(peerRank);
+}
+
+void SocketTransport::disconnect()
+{
+#ifdef __unix__
+    for( int& peerSocket : this->peerSockets )
+        if( peerSocket >= 0 )
+        {
+            ::close(peerSocket);
+            peerSocket = -1;
+        }
+#endif
+}
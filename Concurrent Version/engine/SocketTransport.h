@@ -0,0 +1,60 @@
+#ifndef SOCKETTRANSPORT_H
+#define SOCKETTRANSPORT_H
+
+#include <string>
+#include <vector>
+
+#include "Transport.h"
+
+/**
+ * Transport between processes of the same machine through Unix domain sockets, with one connection to every other
+ * process. Each process listens on the socket path made of the prefix and its rank, connects to the processes of
+ * lower rank and accepts the connections of the higher ones, so they can be started in any order. It lets the
+ * distributed simulation be tried with several local processes, without any cluster library.
+ */
+class SocketTransport : public Transport
+{
+private:
+    std::string socketPrefix;
+    int rank = 0;
+    int processCount = 1;
+    // The connection to every peer, or -1 for this process.
+    std::vector<int> peerSockets;
+
+public:
+    /**
+     * @param socketPrefix Path shared by every process, to which each one appends a dot and its rank.
+     * @param rank Rank of this process.
+     * @param processCount Number of processes of the simulation.
+     */
+    SocketTransport(const std::string& socketPrefix, int rank, int processCount);
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator=(const SocketTransport&) = delete;
+    ~SocketTransport();
+
+    /**
+     * @brief Connects to every other process, waiting for them to start.
+     * @param timeoutSeconds Longest time to wait for the other processes.
+     * @return false if a process did not show up in time, or if sockets are not supported on this system.
+     */
+    bool connect(double timeoutSeconds);
+
+    int getRank() const override;
+    int getProcessCount() const override;
+    bool send(int peer, const void* data, size_t bytes) override;
+    bool receive(int peer, void* data, size_t bytes) override;
+    bool exchange(int peer, const void* sent, void* received, size_t bytes) override;
+
+private:
+    /**
+     * @brief Returns the socket path where the process of the given rank listens.
+     */
+    std::string getSocketPath(int peerRank) const;
+
+    /**
+     * @brief Closes the connections to every peer.
+     */
+    void disconnect();
+};
+
+#endif // SOCKETTRANSPORT_H
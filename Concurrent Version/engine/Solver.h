@@ -0,0 +1,68 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <cstring>
+
+/**
+ * Numerical methods the engine can use to reach the equilibrium state. The order matches the entries of the
+ * solver combo box in MainWindow.ui.
+ */
+enum Solver
+{
+    // Every cell is replaced with the average of its neighbours in the previous generation. Needs two matrices.
+    JACOBI_SOLVER,
+    // Cells are updated in place, first those with an even row + column, then the odd ones. Needs one matrix.
+    RED_BLACK_SOLVER,
+    // Red-black ordering where every cell moves past the average by a relaxation factor. Needs one matrix.
+    SOR_SOLVER,
+    // Geometric multigrid cycles on a hierarchy of coarser matrices, run by the engine without workers. Needs one matrix.
+    MULTIGRID_SOLVER,
+    // The equilibrium state computed in one shot with a sine transform, skipping the generations. Needs one matrix.
+    DIRECT_SOLVER,
+    // Preconditioned conjugate gradient, with every iteration split in phases among the workers. Needs one matrix
+    // plus four vectors of the same size.
+    CONJUGATE_GRADIENT_SOLVER,
+    // Red-black Gauss-Seidel where every worker sweeps its own block without waiting for the others, reading the
+    // latest edges of its neighbours. Needs one matrix, plus a private copy of each block.
+    ASYNCHRONOUS_SOLVER,
+    SOLVER_COUNT
+};
+
+/**
+ * @brief Returns the name used to select the given solver from the command line.
+ */
+inline const char* getSolverName(Solver solver)
+{
+    static const char* const names[] = { "jacobi", "red-black", "sor", "multigrid", "direct", "cg", "async" };
+    return ( solver >= JACOBI_SOLVER && solver < SOLVER_COUNT ) ? names[solver] : "unknown";
+}
+
+/**
+ * @brief Returns true if the solver updates the loaded matrix in place instead of alternating two of them.
+ */
+inline bool isInPlaceSolver(Solver solver)
+{
+    return solver == RED_BLACK_SOLVER || solver == SOR_SOLVER || solver == MULTIGRID_SOLVER || solver == DIRECT_SOLVER
+            || solver == CONJUGATE_GRADIENT_SOLVER || solver == ASYNCHRONOUS_SOLVER;
+}
+
+/**
+ * @brief Returns true if the workers update the matrix one colour at a time, so a generation takes two phases.
+ */
+inline bool isRedBlackSolver(Solver solver)
+{
+    return solver == RED_BLACK_SOLVER || solver == SOR_SOLVER;
+}
+
+/**
+ * @brief Returns the solver with the given name, or SOLVER_COUNT if there is none.
+ */
+inline Solver getSolverByName(const char* name)
+{
+    for( int solver = JACOBI_SOLVER; solver < SOLVER_COUNT; ++solver )
+        if( std::strcmp( name, getSolverName(static_cast<Solver>(solver)) ) == 0 )
+            return static_cast<Solver>(solver);
+    return SOLVER_COUNT;
+}
+
+#endif // SOLVER_H
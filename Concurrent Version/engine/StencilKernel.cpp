@@ -0,0 +1,379 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+
+#include "StencilKernel.h"
+#include "TemperatureGrid.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define STENCIL_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        // MSVC lets any function use any instruction set.
+        #define TARGET(instructionSet)
+    #else
+        #include <cpuid.h>
+        // GCC and Clang compile each variant for its own instruction set, without global -m flags.
+        #define TARGET(instructionSet) __attribute__((target(instructionSet)))
+    #endif
+#endif
+
+typedef double (*SweepFunction)(const double*, double*, size_t, size_t, size_t);
+
+// Every variant adds the neighbours in the same order (right, left, top, bottom) and scales by an exact
+// power of two, so all of them produce bit-identical matrices.
+static double sweepScalar(const double* previous, double* current, size_t stride, size_t rowCount, size_t columnCount)
+{
+    double maximumDelta = 0.0;
+    for( size_t row = 0; row < rowCount; ++row )
+    {
+        const double* center = previous + row * stride;
+        double* target = current + row * stride;
+        for( size_t column = 0; column < columnCount; ++column )
+        {
+            const double sum = center[column + 1] + center[column - 1] + center[column - stride] + center[column + stride];
+            const double temperature = sum * (1.0 / NUMBER_OF_NEIGHBORS);
+            const double delta = std::fabs(temperature - center[column]);
+            target[column] = temperature;
+            if( delta > maximumDelta )
+                maximumDelta = delta;
+        }
+    }
+    return maximumDelta;
+}
+
+#ifdef STENCIL_X86
+
+TARGET("sse2")
+static double sweepSSE2(const double* previous, double* current, size_t stride, size_t rowCount, size_t columnCount)
+{
+    const __m128d quarter = _mm_set1_pd(1.0 / NUMBER_OF_NEIGHBORS);
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    __m128d maximumDelta = _mm_setzero_pd();
+    double tailDelta = 0.0;
+
+    for( size_t row = 0; row < rowCount; ++row )
+    {
+        const double* center = previous + row * stride;
+        double* target = current + row * stride;
+        size_t column = 0;
+        for( ; column + 2 <= columnCount; column += 2 )
+        {
+            __m128d sum = _mm_add_pd( _mm_loadu_pd(center + column + 1), _mm_loadu_pd(center + column - 1) );
+            sum = _mm_add_pd( sum, _mm_loadu_pd(center + column - stride) );
+            sum = _mm_add_pd( sum, _mm_loadu_pd(center + column + stride) );
+            const __m128d temperature = _mm_mul_pd(sum, quarter);
+            const __m128d delta = _mm_andnot_pd( signMask, _mm_sub_pd(temperature, _mm_loadu_pd(center + column)) );
+            _mm_storeu_pd(target + column, temperature);
+            maximumDelta = _mm_max_pd(maximumDelta, delta);
+        }
+        if( column < columnCount )
+        {
+            const double delta = sweepScalar(center + column, target + column, stride, 1, columnCount - column);
+            if( delta > tailDelta )
+                tailDelta = delta;
+        }
+    }
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, maximumDelta);
+    return std::fmax( std::fmax(lanes[0], lanes[1]), tailDelta );
+}
+
+TARGET("avx2")
+static double sweepAVX2(const double* previous, double* current, size_t stride, size_t rowCount, size_t columnCount)
+{
+    const __m256d quarter = _mm256_set1_pd(1.0 / NUMBER_OF_NEIGHBORS);
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    __m256d maximumDelta = _mm256_setzero_pd();
+    double tailDelta = 0.0;
+
+    for( size_t row = 0; row < rowCount; ++row )
+    {
+        const double* center = previous + row * stride;
+        double* target = current + row * stride;
+        size_t column = 0;
+        for( ; column + 4 <= columnCount; column += 4 )
+        {
+            __m256d sum = _mm256_add_pd( _mm256_loadu_pd(center + column + 1), _mm256_loadu_pd(center + column - 1) );
+            sum = _mm256_add_pd( sum, _mm256_loadu_pd(center + column - stride) );
+            sum = _mm256_add_pd( sum, _mm256_loadu_pd(center + column + stride) );
+            const __m256d temperature = _mm256_mul_pd(sum, quarter);
+            const __m256d delta = _mm256_andnot_pd( signMask, _mm256_sub_pd(temperature, _mm256_loadu_pd(center + column)) );
+            _mm256_storeu_pd(target + column, temperature);
+            maximumDelta = _mm256_max_pd(maximumDelta, delta);
+        }
+        if( column < columnCount )
+        {
+            const double delta = sweepScalar(center + column, target + column, stride, 1, columnCount - column);
+            if( delta > tailDelta )
+                tailDelta = delta;
+        }
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, maximumDelta);
+    return std::fmax( std::fmax( std::fmax(lanes[0], lanes[1]), std::fmax(lanes[2], lanes[3]) ), tailDelta );
+}
+
+TARGET("avx512f")
+static double sweepAVX512(const double* previous, double* current, size_t stride, size_t rowCount, size_t columnCount)
+{
+    const __m512d quarter = _mm512_set1_pd(1.0 / NUMBER_OF_NEIGHBORS);
+    __m512d maximumDelta = _mm512_setzero_pd();
+    double tailDelta = 0.0;
+
+    for( size_t row = 0; row < rowCount; ++row )
+    {
+        const double* center = previous + row * stride;
+        double* target = current + row * stride;
+        size_t column = 0;
+        for( ; column + 8 <= columnCount; column += 8 )
+        {
+            __m512d sum = _mm512_add_pd( _mm512_loadu_pd(center + column + 1), _mm512_loadu_pd(center + column - 1) );
+            sum = _mm512_add_pd( sum, _mm512_loadu_pd(center + column - stride) );
+            sum = _mm512_add_pd( sum, _mm512_loadu_pd(center + column + stride) );
+            const __m512d temperature = _mm512_mul_pd(sum, quarter);
+            const __m512d delta = _mm512_abs_pd( _mm512_sub_pd(temperature, _mm512_loadu_pd(center + column)) );
+            _mm512_storeu_pd(target + column, temperature);
+            maximumDelta = _mm512_mask_mov_pd( maximumDelta, _mm512_cmp_pd_mask(delta, maximumDelta, _CMP_GT_OQ), delta );
+        }
+        if( column < columnCount )
+        {
+            const double delta = sweepScalar(center + column, target + column, stride, 1, columnCount - column);
+            if( delta > tailDelta )
+                tailDelta = delta;
+        }
+    }
+
+    double lanes[8];
+    _mm512_storeu_pd(lanes, maximumDelta);
+    for( int lane = 0; lane < 8; ++lane )
+        tailDelta = std::fmax(tailDelta, lanes[lane]);
+    return tailDelta;
+}
+
+static void cpuid(unsigned leaf, unsigned subleaf, unsigned registers[4])
+{
+#if defined(_MSC_VER)
+    __cpuidex(reinterpret_cast<int*>(registers), static_cast<int>(leaf), static_cast<int>(subleaf));
+#else
+    registers[0] = registers[1] = registers[2] = registers[3] = 0;
+    __get_cpuid_count(leaf, subleaf, &registers[0], &registers[1], &registers[2], &registers[3]);
+#endif
+}
+
+// Returns the register state the operating system saves on context switches (XCR0).
+static unsigned long long getEnabledRegisterState()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned low = 0, high = 0;
+    __asm__ volatile ( "xgetbv" : "=a"(low), "=d"(high) : "c"(0) );
+    return (static_cast<unsigned long long>(high) << 32) | low;
+#endif
+}
+
+static StencilKernel::Variant detectBestVariant()
+{
+    unsigned registers[4];
+    cpuid(0, 0, registers);
+    const unsigned maximumLeaf = registers[0];
+
+    cpuid(1, 0, registers);
+    if( !(registers[3] & (1u << 26)) )
+        return StencilKernel::SCALAR;
+
+    // AVX needs the OS to save the YMM registers, signalled through OSXSAVE and XCR0.
+    const bool osSavesRegisters = (registers[2] & (1u << 27)) != 0;
+    const bool hasAVX = (registers[2] & (1u << 28)) != 0;
+    if( !osSavesRegisters || !hasAVX || maximumLeaf < 7 )
+        return StencilKernel::SSE2;
+
+    const unsigned long long registerState = getEnabledRegisterState();
+    if( (registerState & 0x6) != 0x6 )
+        return StencilKernel::SSE2;
+
+    cpuid(7, 0, registers);
+    const bool hasAVX2 = (registers[1] & (1u << 5)) != 0;
+    const bool hasAVX512 = (registers[1] & (1u << 16)) != 0;
+    if( hasAVX512 && (registerState & 0xE6) == 0xE6 )
+        return StencilKernel::AVX512;
+    return hasAVX2 ? StencilKernel::AVX2 : StencilKernel::SSE2;
+}
+
+#else
+
+static StencilKernel::Variant detectBestVariant()
+{
+    return StencilKernel::SCALAR;
+}
+
+#endif // STENCIL_X86
+
+static SweepFunction getSweepFunction(StencilKernel::Variant variant)
+{
+    switch( variant )
+    {
+#ifdef STENCIL_X86
+        case StencilKernel::SSE2: return sweepSSE2;
+        case StencilKernel::AVX2: return sweepAVX2;
+        case StencilKernel::AVX512: return sweepAVX512;
+#endif
+        default: return sweepScalar;
+    }
+}
+
+// The dispatcher picks the variant once, the first time the kernel is used. It may be changed while other threads
+// sweep, so both are atomic.
+static std::atomic<StencilKernel::Variant>& selectedVariant()
+{
+    static std::atomic<StencilKernel::Variant> variant( StencilKernel::getBestSupportedVariant() );
+    return variant;
+}
+
+static std::atomic<SweepFunction>& selectedSweep()
+{
+    static std::atomic<SweepFunction> sweep( getSweepFunction( selectedVariant().load() ) );
+    return sweep;
+}
+
+StencilKernel::Variant StencilKernel::getBestSupportedVariant()
+{
+    static const Variant bestVariant = detectBestVariant();
+    return bestVariant;
+}
+
+bool StencilKernel::isSupported(Variant variant)
+{
+    return variant >= SCALAR && variant <= getBestSupportedVariant();
+}
+
+StencilKernel::Variant StencilKernel::getSelectedVariant()
+{
+    return selectedVariant().load();
+}
+
+bool StencilKernel::setSelectedVariant(Variant variant)
+{
+    if( !isSupported(variant) )
+        return false;
+    selectedVariant().store(variant);
+    selectedSweep().store( getSweepFunction(variant) );
+    return true;
+}
+
+const char* StencilKernel::getVariantName(Variant variant)
+{
+    static const char* const names[] = { "scalar", "SSE2", "AVX2", "AVX-512" };
+    return ( variant >= SCALAR && variant < VARIANT_COUNT ) ? names[variant] : "unknown";
+}
+
+double StencilKernel::sweep(const double* previous, double* current, size_t stride, size_t rowCount, size_t columnCount)
+{
+    return selectedSweep().load(std::memory_order_relaxed)(previous, current, stride, rowCount, columnCount);
+}
+
+double StencilKernel::sweep(Variant variant, const double* previous, double* current, size_t stride, size_t rowCount, size_t columnCount)
+{
+    return getSweepFunction(variant)(previous, current, stride, rowCount, columnCount);
+}
+
+double StencilKernel::sweepColor(double* cells, size_t stride, size_t firstRow, size_t firstColumn, size_t rowCount, size_t columnCount, int color, double relaxationFactor)
+{
+    // Gauss-Seidel keeps the plain average, so it stays bit-identical to the Jacobi formula.
+    const bool overRelaxed = relaxationFactor != 1.0;
+    double maximumDelta = 0.0;
+    for( size_t row = 0; row < rowCount; ++row )
+    {
+        double* center = cells + row * stride;
+        for( size_t column = (firstRow + row + firstColumn + color) & 1; column < columnCount; column += 2 )
+        {
+            const double sum = center[column + 1] + center[column - 1] + center[column - stride] + center[column + stride];
+            double temperature = sum * (1.0 / NUMBER_OF_NEIGHBORS);
+            if( overRelaxed )
+                temperature = center[column] + relaxationFactor * (temperature - center[column]);
+            const double delta = std::fabs(temperature - center[column]);
+            center[column] = temperature;
+            if( delta > maximumDelta )
+                maximumDelta = delta;
+        }
+    }
+    return maximumDelta;
+}
+
+double StencilKernel::sweepTiles(Variant variant, const double* previous, double* current, size_t stride, size_t rowCount, size_t columnCount, size_t tileHeight, size_t tileWidth)
+{
+    const SweepFunction sweepFunction = getSweepFunction(variant);
+    if( tileHeight == 0 )
+        tileHeight = 1;
+    if( tileWidth == 0 )
+        tileWidth = columnCount;
+
+    double maximumDelta = 0.0;
+    for( size_t row = 0; row < rowCount; row += tileHeight )
+    {
+        const size_t tileRows = std::min(tileHeight, rowCount - row);
+        for( size_t column = 0; column < columnCount; column += tileWidth )
+        {
+            const size_t offset = row * stride + column;
+            const double delta = sweepFunction( previous + offset, current + offset, stride, tileRows, std::min(tileWidth, columnCount - column) );
+            if( delta > maximumDelta )
+                maximumDelta = delta;
+        }
+    }
+    return maximumDelta;
+}
+
+double StencilKernel::getBytesPerCell(size_t tileHeight, size_t tileWidth)
+{
+    if( tileHeight == 0 || tileWidth == 0 )
+        return 0.0;
+    const double cells = static_cast<double>(tileHeight) * tileWidth;
+    const double cellsRead = static_cast<double>(tileHeight + 2) * tileWidth + 2.0 * tileHeight;
+    return (cellsRead + cells) * sizeof(double) / cells;
+}
+
+void StencilKernel::reportThroughput(std::ostream& output, size_t rows, size_t columns, size_t generations)
+{
+    if( rows < 3 || columns < 3 || generations == 0 )
+        return;
+
+    // A hot border around a cold interior, so every generation changes the cells.
+    TemperatureGrid previous(rows, columns, 100.0);
+    for( size_t row = 1; row < rows - 1; ++row )
+        for( size_t column = 1; column < columns - 1; ++column )
+            previous(row, column) = 0.0;
+    TemperatureGrid current(previous);
+
+    const double interiorCells = static_cast<double>(rows - 2) * static_cast<double>(columns - 2);
+    output << "Stencil kernel throughput on a " << rows << "x" << columns << " matrix, " << generations << " generations:\n";
+
+    for( int variant = SCALAR; variant < VARIANT_COUNT; ++variant )
+    {
+        const Variant currentVariant = static_cast<Variant>(variant);
+        output << "  " << getVariantName(currentVariant) << ": ";
+        if( !isSupported(currentVariant) )
+        {
+            output << "not supported\n";
+            continue;
+        }
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for( size_t generation = 0; generation < generations; ++generation )
+        {
+            sweep(currentVariant, previous.row(1) + 1, current.row(1) + 1, previous.getStride(), rows - 2, columns - 2);
+            previous.swap(current);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        output << interiorCells * generations / elapsed.count() << " cells/s";
+        if( currentVariant == getSelectedVariant() )
+            output << " (selected)";
+        output << "\n";
+    }
+}
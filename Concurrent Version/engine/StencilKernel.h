@@ -0,0 +1,112 @@
+#ifndef STENCILKERNEL_H
+#define STENCILKERNEL_H
+
+#include <cstddef>
+#include <iosfwd>
+
+#define NUMBER_OF_NEIGHBORS 4
+
+class StencilKernel
+{
+public:
+    /**
+     * @brief Instruction set used to sweep the interior of the matrix, from the slowest to the fastest.
+     */
+    enum Variant
+    {
+        SCALAR,
+        SSE2,
+        AVX2,
+        AVX512,
+        VARIANT_COUNT
+    };
+
+    /**
+     * @brief Returns the fastest variant supported by the processor, as reported by CPUID.
+     */
+    static Variant getBestSupportedVariant();
+
+    /**
+     * @brief Returns true if the processor (and the operating system) can run the given variant.
+     */
+    static bool isSupported(Variant variant);
+
+    /**
+     * @brief Returns the variant used by sweep() without a variant, and the one engines start with. At startup it
+     * is the best supported one.
+     */
+    static Variant getSelectedVariant();
+
+    /**
+     * @brief Forces sweep() without a variant to use the given one, from any thread. The engines that already exist
+     * keep theirs. Unsupported variants are ignored.
+     * @return true if the variant was selected.
+     */
+    static bool setSelectedVariant(Variant variant);
+
+    /**
+     * @brief Returns a printable name for the given variant.
+     */
+    static const char* getVariantName(Variant variant);
+
+    /**
+     * @brief Replaces every cell of a rectangle with the average of its four neighbours in the previous matrix.
+     * The rectangle must not touch the border of the matrix, since its neighbours are read without bound checks.
+     * @param previous First cell of the rectangle in the previous matrix.
+     * @param current First cell of the rectangle in the current matrix.
+     * @param stride Distance, in cells, between two consecutive rows of both matrices.
+     * @param rowCount Number of rows of the rectangle.
+     * @param columnCount Number of columns of the rectangle.
+     * @return The maximum absolute difference between a new temperature and its previous value.
+     */
+    static double sweep(const double* previous, double* current, size_t stride, size_t rowCount, size_t columnCount);
+
+    /**
+     * @brief Same as sweep(), but using the given variant instead of the selected one.
+     */
+    static double sweep(Variant variant, const double* previous, double* current, size_t stride, size_t rowCount, size_t columnCount);
+
+    /**
+     * @brief Replaces in place the cells of one colour of a rectangle with the average of their four neighbours.
+     * A cell is red when its interior row plus its interior column is even, and black otherwise, so the
+     * neighbours of a colour always have the other one and both halves can be split among workers freely.
+     * @param cells First cell of the rectangle.
+     * @param stride Distance, in cells, between two consecutive rows.
+     * @param firstRow Interior row of the first row of the rectangle, used to know the colour of its cells.
+     * @param firstColumn Interior column of the first column of the rectangle, used to know the colour of its cells.
+     * @param rowCount Number of rows of the rectangle.
+     * @param columnCount Number of columns of the rectangle.
+     * @param color Zero to update the red cells, one to update the black ones.
+     * @param relaxationFactor Successive over-relaxation factor. Each cell moves this many times the distance to the
+     * average of its neighbours. One is plain Gauss-Seidel, and gives exactly the average.
+     * @return The maximum absolute difference between a new temperature and the value it replaced.
+     */
+    static double sweepColor(double* cells, size_t stride, size_t firstRow, size_t firstColumn, size_t rowCount, size_t columnCount, int color, double relaxationFactor = 1.0);
+
+    /**
+     * @brief Sweeps a rectangle tile by tile, so the rows read by a tile stay in cache while it is computed.
+     * Tiles are visited from left to right and then from top to bottom.
+     * @param variant Variant every tile is swept with.
+     * @param tileHeight Number of rows of each tile. Zero means one row.
+     * @param tileWidth Number of columns of each tile. Zero means the whole width of the rectangle.
+     * @return The maximum absolute difference between a new temperature and its previous value.
+     */
+    static double sweepTiles(Variant variant, const double* previous, double* current, size_t stride, size_t rowCount, size_t columnCount, size_t tileHeight, size_t tileWidth);
+
+    /**
+     * @brief Estimates the bytes moved between memory and cache to update one cell of a tile of the given shape.
+     * Each tile reads its cells plus a one cell halo once, and writes its cells once.
+     */
+    static double getBytesPerCell(size_t tileHeight, size_t tileWidth);
+
+    /**
+     * @brief Sweeps a synthetic matrix with every supported variant and prints their throughput in cells per second.
+     * @param output Stream where the report is printed.
+     * @param rows Number of rows of the synthetic matrix.
+     * @param columns Number of columns of the synthetic matrix.
+     * @param generations Number of sweeps measured for each variant.
+     */
+    static void reportThroughput(std::ostream& output, size_t rows, size_t columns, size_t generations);
+};
+
+#endif // STENCILKERNEL_H
@@ -0,0 +1,277 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "NumaTopology.h"
+#include "TemperatureGrid.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Number of cells that fit in one aligned block.
+#define CELLS_PER_BLOCK (GRID_ALIGNMENT / sizeof(double))
+
+TemperatureGrid::TemperatureGrid()
+{}
+
+TemperatureGrid::TemperatureGrid(size_t rows, size_t columns, double value)
+{
+    this->resize(rows, columns, value);
+}
+
+TemperatureGrid::TemperatureGrid(const TemperatureGrid& other)
+    : rows(other.rows)
+    , columns(other.columns)
+    , stride(other.stride)
+{
+    this->allocate();
+    if( this->data )
+        std::memcpy(this->data, other.data, this->getCellCount() * sizeof(double));
+}
+
+TemperatureGrid::TemperatureGrid(TemperatureGrid&& other) noexcept
+{
+    this->swap(other);
+}
+
+TemperatureGrid& TemperatureGrid::operator=(const TemperatureGrid& other)
+{
+    if( this != &other )
+    {
+        TemperatureGrid copy(other);
+        this->swap(copy);
+    }
+    return *this;
+}
+
+TemperatureGrid& TemperatureGrid::operator=(TemperatureGrid&& other) noexcept
+{
+    this->swap(other);
+    return *this;
+}
+
+TemperatureGrid::~TemperatureGrid()
+{
+    this->release();
+}
+
+void TemperatureGrid::resize(size_t rows, size_t columns, double value)
+{
+    this->clear();
+    this->rows = rows;
+    this->columns = columns;
+    // Round the row length up to a whole number of aligned blocks.
+    this->stride = (columns + CELLS_PER_BLOCK - 1) / CELLS_PER_BLOCK * CELLS_PER_BLOCK;
+    this->allocate();
+
+    // The padding between rows is zeroed too, so vectorized loops that run past the last column read defined values.
+    for( size_t cell = 0; cell < this->getCellCount(); ++cell )
+        this->data[cell] = 0.0;
+    for( size_t row = 0; row < this->rows; ++row )
+    {
+        double * cells = this->row(row);
+        for( size_t column = 0; column < this->columns; ++column )
+            cells[column] = value;
+    }
+}
+
+void TemperatureGrid::reshape(size_t rows, size_t columns, bool interleaved)
+{
+    this->clear();
+    this->rows = rows;
+    this->columns = columns;
+    this->stride = (columns + CELLS_PER_BLOCK - 1) / CELLS_PER_BLOCK * CELLS_PER_BLOCK;
+    const size_t cellCount = this->getCellCount();
+    if( cellCount == 0 )
+        return;
+
+#ifdef __linux__
+    // The heap may hand back pages another thread already wrote, so the storage is mapped from the system.
+    const size_t bytes = cellCount * sizeof(double) + 2 * GRID_ALIGNMENT;
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if( mapping == MAP_FAILED )
+        throw std::bad_alloc();
+    this->allocation = mapping;
+    this->mappedBytes = bytes;
+    if( interleaved )
+        NumaTopology::interleave(mapping, bytes);
+
+    // Mappings start on a page boundary, so only the border column needs to be shifted.
+    this->data = reinterpret_cast<double*>(mapping) + CELLS_PER_BLOCK - 1;
+#else
+    (void) interleaved;
+    this->allocate();
+#endif
+}
+
+bool TemperatureGrid::mapFile(const std::string& filePath, size_t rows, size_t columns, size_t stride, size_t firstCellOffset, bool shared)
+{
+#ifdef __linux__
+    const size_t cellCount = rows == 0 ? 0 : (rows - 1) * stride + columns;
+    if( cellCount == 0 || stride != (columns + CELLS_PER_BLOCK - 1) / CELLS_PER_BLOCK * CELLS_PER_BLOCK
+            || (firstCellOffset + sizeof(double)) % GRID_ALIGNMENT != 0 )
+        return false;
+
+    const int descriptor = open(filePath.c_str(), shared ? O_RDWR : O_RDONLY);
+    if( descriptor < 0 )
+        return false;
+    // Mappings start on a page boundary, so the cells keep the alignment they have in the file.
+    const size_t bytes = firstCellOffset + cellCount * sizeof(double);
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, shared ? MAP_SHARED : MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if( mapping == MAP_FAILED )
+        return false;
+
+    this->clear();
+    this->rows = rows;
+    this->columns = columns;
+    this->stride = stride;
+    this->allocation = mapping;
+    this->mappedBytes = bytes;
+    this->data = reinterpret_cast<double*>( static_cast<char*>(mapping) + firstCellOffset );
+    return true;
+#else
+    (void) filePath; (void) rows; (void) columns; (void) stride; (void) firstCellOffset; (void) shared;
+    return false;
+#endif
+}
+
+void TemperatureGrid::assign(const TemperatureGrid& source)
+{
+    if( this == &source )
+        return;
+    if( source.rows != this->rows || source.columns != this->columns || !this->data )
+    {
+        *this = source;
+        return;
+    }
+    std::memcpy(this->data, source.data, this->getCellCount() * sizeof(double));
+}
+
+void TemperatureGrid::copyBorder(const TemperatureGrid& source)
+{
+    if( source.rows != this->rows || source.columns != this->columns || this->rows == 0 )
+        return;
+
+    const size_t lastColumn = this->columns - 1;
+    for( size_t row = 0; row < this->rows; ++row )
+    {
+        double * cells = this->row(row);
+        const double * sourceCells = source.row(row);
+        if( row == 0 || row == this->rows - 1 )
+        {
+            for( size_t column = 0; column < this->columns; ++column )
+                cells[column] = sourceCells[column];
+        }
+        else
+        {
+            cells[0] = sourceCells[0];
+            cells[lastColumn] = sourceCells[lastColumn];
+        }
+        // The last row has no padding, since it is not counted in the cells of the grid.
+        if( row + 1 < this->rows )
+            for( size_t column = this->columns; column < this->stride; ++column )
+                cells[column] = 0.0;
+    }
+}
+
+void TemperatureGrid::fill(double value)
+{
+    for( size_t row = 0; row < this->rows; ++row )
+    {
+        double * cells = this->row(row);
+        for( size_t column = 0; column < this->columns; ++column )
+            cells[column] = value;
+    }
+}
+
+void TemperatureGrid::clear()
+{
+    this->release();
+    this->allocation = nullptr;
+    this->mappedBytes = 0;
+    this->data = nullptr;
+    this->rows = this->columns = this->stride = 0;
+}
+
+void TemperatureGrid::swap(TemperatureGrid& other) noexcept
+{
+    std::swap(this->rows, other.rows);
+    std::swap(this->columns, other.columns);
+    std::swap(this->stride, other.stride);
+    std::swap(this->allocation, other.allocation);
+    std::swap(this->mappedBytes, other.mappedBytes);
+    std::swap(this->data, other.data);
+}
+
+bool TemperatureGrid::empty() const
+{
+    return this->rows == 0 || this->columns == 0;
+}
+
+size_t TemperatureGrid::getNumberOfRows() const
+{
+    return this->rows;
+}
+
+size_t TemperatureGrid::getNumberOfColumns() const
+{
+    return this->columns;
+}
+
+size_t TemperatureGrid::getStride() const
+{
+    return this->stride;
+}
+
+size_t TemperatureGrid::getInteriorRows() const
+{
+    return this->rows > 2 ? this->rows - 2 : 0;
+}
+
+size_t TemperatureGrid::getInteriorColumns() const
+{
+    return this->columns > 2 ? this->columns - 2 : 0;
+}
+
+size_t TemperatureGrid::getCellCount() const
+{
+    // The last row does not need the padding after its last column.
+    return this->rows == 0 ? 0 : (this->rows - 1) * this->stride + this->columns;
+}
+
+void TemperatureGrid::allocate()
+{
+    const size_t cellCount = this->getCellCount();
+    if( cellCount == 0 )
+        return;
+
+    // The cells do not start on the boundary: the left border column sits one cell before it, so the interior does.
+    // The start is therefore aligned by hand in an over-allocated block, with one extra block of room for the shift,
+    // which also keeps it portable to compilers without std::aligned_alloc, such as MSVC.
+    this->allocation = std::malloc(cellCount * sizeof(double) + 2 * GRID_ALIGNMENT);
+    if( !this->allocation )
+        throw std::bad_alloc();
+
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(this->allocation);
+    address = (address + GRID_ALIGNMENT - 1) / GRID_ALIGNMENT * GRID_ALIGNMENT;
+    // The first column is the left border, so it is placed one cell before the boundary and the interior starts on it.
+    this->data = reinterpret_cast<double*>(address) + CELLS_PER_BLOCK - 1;
+}
+
+void TemperatureGrid::release()
+{
+#ifdef __linux__
+    if( this->mappedBytes > 0 )
+    {
+        munmap(this->allocation, this->mappedBytes);
+        return;
+    }
+#endif
+    std::free(this->allocation);
+}
@@ -0,0 +1,165 @@
+#ifndef TEMPERATUREGRID_H
+#define TEMPERATUREGRID_H
+
+#include <cstddef>
+#include <string>
+
+// The first interior cell of every row starts on a cache line boundary, so rows are padded up to this many bytes.
+#define GRID_ALIGNMENT 64
+
+/**
+ * The outermost rows and columns of the grid are its border. The simulation never changes them, so the
+ * interior rectangle is stored surrounded by them as a ghost frame: the stencil of any interior cell can
+ * read its four neighbours without checking whether it is next to the border.
+ */
+class TemperatureGrid
+{
+private:
+    size_t rows = 0;
+    size_t columns = 0;
+    size_t stride = 0;
+
+    void * allocation = nullptr;
+    // Non-zero when the storage was mapped straight from the system by reshape(), instead of taken from the heap.
+    size_t mappedBytes = 0;
+    double * data = nullptr;
+
+public:
+    TemperatureGrid();
+    TemperatureGrid(size_t rows, size_t columns, double value = 0.0);
+    TemperatureGrid(const TemperatureGrid& other);
+    TemperatureGrid(TemperatureGrid&& other) noexcept;
+    TemperatureGrid& operator=(const TemperatureGrid& other);
+    TemperatureGrid& operator=(TemperatureGrid&& other) noexcept;
+    ~TemperatureGrid();
+
+    /**
+      * @brief Reallocates the grid with the given dimensions, discarding its previous contents.
+      * @param rows Number of rows.
+      * @param columns Number of columns.
+      * @param value Initial value of every cell.
+      */
+    void resize(size_t rows, size_t columns, double value = 0.0);
+
+    /**
+      * @brief Reallocates the grid with the given dimensions without writing any cell, in pages that no thread used
+      * before, so every page is placed on the NUMA node of the first thread that writes it. The contents are
+      * undefined until they are written.
+      * @param rows Number of rows.
+      * @param columns Number of columns.
+      * @param interleaved Spread the pages round robin over every node instead.
+      */
+    void reshape(size_t rows, size_t columns, bool interleaved = false);
+
+    /**
+      * @brief Replaces the storage of the grid with a mapping of a file whose cells are laid out as a grid's, so
+      * nothing is copied. A private mapping is copy on write, so cells written later never reach the file. A shared
+      * one writes them to the file, so the system can write its pages back and evict them instead of swapping them.
+      * @param filePath The file, which must hold every cell of the grid.
+      * @param rows Number of rows.
+      * @param columns Number of columns.
+      * @param stride Distance, in cells, between two rows in the file. It must be the stride of a grid of this size.
+      * @param firstCellOffset Offset in bytes of the first cell. The cell after it must be aligned to GRID_ALIGNMENT.
+      * @param shared Map the file shared instead of private.
+      * @return false if the file cannot be mapped with this layout, leaving the grid unchanged.
+      */
+    bool mapFile(const std::string& filePath, size_t rows, size_t columns, size_t stride, size_t firstCellOffset, bool shared = false);
+
+    /**
+      * @brief Copies every cell of the given grid, reusing the storage when both have the same dimensions.
+      */
+    void assign(const TemperatureGrid& source);
+
+    /**
+      * @brief Copies the border of a grid with the same dimensions and zeroes the padding after every row, without
+      * writing the interior.
+      */
+    void copyBorder(const TemperatureGrid& source);
+
+    /**
+      * @brief Sets every cell of the grid, border included, to the given value without reallocating it.
+      */
+    void fill(double value);
+
+    /**
+      * @brief Releases the storage of the grid, leaving it with zero rows and columns.
+      */
+    void clear();
+
+    /**
+      * @brief Exchanges the storage of both grids without copying any cell.
+      * @param other Grid to swap with.
+      */
+    void swap(TemperatureGrid& other) noexcept;
+
+    /**
+      * @brief Returns true if the grid has no cells.
+      */
+    bool empty() const;
+
+    /**
+      * @brief Returns the number of rows of the grid.
+      */
+    size_t getNumberOfRows() const;
+
+    /**
+      * @brief Returns the number of columns of the grid.
+      */
+    size_t getNumberOfColumns() const;
+
+    /**
+      * @brief Returns the distance, in cells, between the start of two consecutive rows.
+      * It is always a multiple of GRID_ALIGNMENT bytes, so it can be greater than the number of columns.
+      */
+    size_t getStride() const;
+
+    /**
+      * @brief Returns the number of rows that are not part of the border.
+      */
+    size_t getInteriorRows() const;
+
+    /**
+      * @brief Returns the number of columns that are not part of the border.
+      */
+    size_t getInteriorColumns() const;
+
+    /**
+      * @brief Returns a pointer to the first interior cell of the given interior row. It is aligned to GRID_ALIGNMENT.
+      * @param interiorRow Desired row, counting from the first row after the border.
+      */
+    inline double * interior(size_t interiorRow) { return this->row(interiorRow + 1) + 1; }
+    inline const double * interior(size_t interiorRow) const { return this->row(interiorRow + 1) + 1; }
+
+    /**
+      * @brief Returns a pointer to the first cell of the given row. Rows are stored contiguously, one stride apart.
+      * @param row Desired row.
+      */
+    inline double * row(size_t row) { return this->data + row * this->stride; }
+    inline const double * row(size_t row) const { return this->data + row * this->stride; }
+
+    /**
+      * @brief Returns the cell located at the given row and column.
+      * @param row Desired row.
+      * @param column Desired column.
+      */
+    inline double& operator()(size_t row, size_t column) { return this->data[row * this->stride + column]; }
+    inline const double& operator()(size_t row, size_t column) const { return this->data[row * this->stride + column]; }
+
+private:
+    /**
+      * @brief Returns the number of cells, padding included, between the first and the last cell of the grid.
+      */
+    size_t getCellCount() const;
+
+    /**
+      * @brief Allocates aligned storage for the current dimensions and stride.
+      */
+    void allocate();
+
+    /**
+      * @brief Returns the storage to the heap or to the system, depending on where it came from.
+      */
+    void release();
+};
+
+#endif // TEMPERATUREGRID_H
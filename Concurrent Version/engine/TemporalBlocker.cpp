@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cstring>
+
+#include "TemporalBlocker.h"
+
+TemporalBlocker::TemporalBlocker()
+{}
+
+double TemporalBlocker::advance(const TemperatureGrid& previous, TemperatureGrid& current, size_t firstRow, size_t firstColumn
+                                , size_t rowCount, size_t columnCount, size_t generations, StencilKernel::Variant variant)
+{
+    if( rowCount == 0 || columnCount == 0 )
+        return 0.0;
+    if( generations == 0 )
+        generations = 1;
+
+    // The rectangle in matrix coordinates, border included.
+    const size_t coreTop = firstRow + 1;
+    const size_t coreLeft = firstColumn + 1;
+    const size_t coreBottom = coreTop + rowCount;
+    const size_t coreRight = coreLeft + columnCount;
+    const size_t lastRow = previous.getNumberOfRows() - 1;
+    const size_t lastColumn = previous.getNumberOfColumns() - 1;
+
+    // The halo loses one valid cell per generation, so it is as wide as the number of generations.
+    const size_t top = coreTop > generations ? coreTop - generations : 0;
+    const size_t left = coreLeft > generations ? coreLeft - generations : 0;
+    const size_t bottom = std::min(coreBottom + generations, lastRow + 1);
+    const size_t right = std::min(coreRight + generations, lastColumn + 1);
+    const size_t height = bottom - top;
+    const size_t width = right - left;
+
+    if( this->source.getNumberOfRows() < height || this->source.getNumberOfColumns() < width )
+    {
+        this->source.resize( std::max(height, this->source.getNumberOfRows()), std::max(width, this->source.getNumberOfColumns()) );
+        this->target.resize( this->source.getNumberOfRows(), this->source.getNumberOfColumns() );
+    }
+
+    // Both buffers start with the halo, since border cells in it are read but never written.
+    for( size_t row = 0; row < height; ++row )
+    {
+        std::memcpy( this->source.row(row), previous.row(top + row) + left, width * sizeof(double) );
+        std::memcpy( this->target.row(row), previous.row(top + row) + left, width * sizeof(double) );
+    }
+
+    const size_t stride = this->source.getStride();
+    double maximumDelta = 0.0;
+    for( size_t generation = 1; generation <= generations; ++generation )
+    {
+        // Cells closer to the edge of the halo than the generations left are no longer needed.
+        const size_t margin = generations - generation;
+        const size_t rowBegin = std::max( coreTop > margin ? coreTop - margin : 0, static_cast<size_t>(1) );
+        const size_t rowEnd = std::min( coreBottom + margin, lastRow );
+        const size_t columnBegin = std::max( coreLeft > margin ? coreLeft - margin : 0, static_cast<size_t>(1) );
+        const size_t columnEnd = std::min( coreRight + margin, lastColumn );
+
+        const size_t offset = (rowBegin - top) * stride + (columnBegin - left);
+        maximumDelta = StencilKernel::sweep( variant, this->source.row(0) + offset, this->target.row(0) + offset, stride, rowEnd - rowBegin, columnEnd - columnBegin );
+        this->source.swap(this->target);
+    }
+
+    // In the last generation only the rectangle itself is swept, so the delta covers exactly its cells.
+    for( size_t row = coreTop; row < coreBottom; ++row )
+        std::memcpy( current.row(row) + coreLeft, this->source.row(row - top) + (coreLeft - left), columnCount * sizeof(double) );
+
+    return maximumDelta;
+}
@@ -0,0 +1,40 @@
+#ifndef TEMPORALBLOCKER_H
+#define TEMPORALBLOCKER_H
+
+#include <cstddef>
+
+#include "StencilKernel.h"
+#include "TemperatureGrid.h"
+
+/**
+ * Advances a tile of the matrix several generations at once. The tile is copied with a halo as wide as the
+ * number of generations into a small buffer that stays in cache, so the matrix is read and written once for
+ * all of them instead of once per generation. Every cell is calculated with the same neighbours and in the
+ * same order as in plain Jacobi, so the result is bit-identical to running the generations one by one.
+ */
+class TemporalBlocker
+{
+private:
+    TemperatureGrid source;
+    TemperatureGrid target;
+
+public:
+    TemporalBlocker();
+
+    /**
+      * @brief Calculates the given number of generations for an interior rectangle of the matrix.
+      * @param previous Matrix with the generation the rectangle starts from. It is only read.
+      * @param current Matrix where the rectangle is written after the last generation.
+      * @param firstRow First interior row of the rectangle.
+      * @param firstColumn First interior column of the rectangle.
+      * @param rowCount Number of rows of the rectangle.
+      * @param columnCount Number of columns of the rectangle.
+      * @param generations Number of generations to advance.
+      * @param variant Variant of the stencil kernel every generation is swept with.
+      * @return The maximum absolute difference between the last two generations inside the rectangle.
+      */
+    double advance(const TemperatureGrid& previous, TemperatureGrid& current, size_t firstRow, size_t firstColumn
+                   , size_t rowCount, size_t columnCount, size_t generations, StencilKernel::Variant variant);
+};
+
+#endif // TEMPORALBLOCKER_H
@@ -0,0 +1,166 @@
+#include <algorithm>
+
+#include "HeatMapWorker.h"
+#include "TileScheduler.h"
+
+static uint64_t packRange(uint64_t front, uint64_t back)
+{
+    return front | back << 32;
+}
+
+const char* TileScheduler::getDecompositionName(Decomposition decomposition)
+{
+    static const char* const names[] = { "rows", "blocks" };
+    return ( decomposition >= ROW_STRIPES && decomposition < DECOMPOSITION_COUNT ) ? names[decomposition] : "unknown";
+}
+
+void TileScheduler::chooseGrid(size_t rowCount, size_t columnCount, int workerCount, int& gridRows, int& gridColumns)
+{
+    gridRows = workerCount > 0 ? workerCount : 1;
+    gridColumns = 1;
+    double shortestBorder = -1.0;
+
+    // Every cut across the rows is as long as a row, and every cut across the columns as long as a column.
+    for( int rows = 1; rows <= workerCount; ++rows )
+    {
+        if( workerCount % rows != 0 )
+            continue;
+        const int columns = workerCount / rows;
+        if( static_cast<size_t>(rows) > rowCount || static_cast<size_t>(columns) > columnCount )
+            continue;
+        const double border = static_cast<double>(rows - 1) * columnCount + static_cast<double>(columns - 1) * rowCount;
+        if( shortestBorder < 0.0 || border < shortestBorder )
+        {
+            shortestBorder = border;
+            gridRows = rows;
+            gridColumns = columns;
+        }
+    }
+}
+
+void TileScheduler::setup(size_t rowCount, size_t columnCount, int workerCount, size_t rowMultiple, Decomposition decomposition, bool stealing)
+{
+    this->workerCount = workerCount > 0 ? workerCount : 1;
+    this->stealing = stealing;
+    this->gridRows = this->workerCount;
+    this->gridColumns = 1;
+    if( decomposition == BLOCKS )
+        chooseGrid(rowCount, columnCount, this->workerCount, this->gridRows, this->gridColumns);
+
+    // Workers go through the blocks row by row, and every block is split in bands so the others can steal from it.
+    this->tiles.clear();
+    this->firstTiles.assign(1, 0);
+    for( int workerId = 0; workerId < this->workerCount; ++workerId )
+    {
+        const int blockRow = workerId / this->gridColumns;
+        const int blockColumn = workerId % this->gridColumns;
+        const size_t startRow = HeatMapWorker::calculateStart(rowCount, this->gridRows, blockRow);
+        const size_t finishRow = HeatMapWorker::calculateFinish(rowCount, this->gridRows, blockRow);
+        const size_t startColumn = HeatMapWorker::calculateStart(columnCount, this->gridColumns, blockColumn);
+        const size_t finishColumn = HeatMapWorker::calculateFinish(columnCount, this->gridColumns, blockColumn);
+
+        const size_t blockRows = finishRow - startRow;
+        size_t tileRows = blockRows > SCHEDULER_TILES_PER_WORKER ? (blockRows + SCHEDULER_TILES_PER_WORKER - 1) / SCHEDULER_TILES_PER_WORKER : 1;
+        const size_t blockColumns = finishColumn - startColumn;
+        if( blockColumns > 0 )
+            tileRows = std::min( tileRows, std::max( static_cast<size_t>(SCHEDULER_MAXIMUM_TILE_CELLS) / blockColumns, static_cast<size_t>(1) ) );
+        if( rowMultiple > 1 )
+            tileRows = (tileRows + rowMultiple - 1) / rowMultiple * rowMultiple;
+        for( size_t row = startRow; row < finishRow && startColumn < finishColumn; row += tileRows )
+            this->tiles.push_back( Tile{ row, row + tileRows < finishRow ? row + tileRows : finishRow, startColumn, finishColumn } );
+        this->firstTiles.push_back( this->tiles.size() );
+    }
+
+    // The atomics cannot be copied, so the deques are built in place.
+    std::vector<WorkerDeque> deques(this->workerCount);
+    this->deques.swap(deques);
+    this->reset();
+}
+
+void TileScheduler::reset()
+{
+    for( int workerId = 0; workerId < this->workerCount; ++workerId )
+        this->deques[workerId].range.store( packRange(this->firstTiles[workerId], this->firstTiles[workerId + 1]), std::memory_order_relaxed );
+}
+
+bool TileScheduler::takeTile(int workerId, size_t& tile)
+{
+    // The own deque first, from the front, so the worker keeps walking down the rows it had in cache.
+    std::atomic<uint64_t>& own = this->deques[workerId].range;
+    uint64_t range = own.load(std::memory_order_acquire);
+    while( (range & 0xFFFFFFFF) < (range >> 32) )
+    {
+        if( own.compare_exchange_weak(range, range + 1, std::memory_order_acq_rel) )
+        {
+            tile = range & 0xFFFFFFFF;
+            return true;
+        }
+    }
+    if( !this->stealing )
+        return false;
+
+    // Then the others, from the back, so the thief and the owner work as far apart as possible.
+    for( int offset = 1; offset < this->workerCount; ++offset )
+    {
+        std::atomic<uint64_t>& victim = this->deques[(workerId + offset) % this->workerCount].range;
+        range = victim.load(std::memory_order_acquire);
+        while( (range & 0xFFFFFFFF) < (range >> 32) )
+        {
+            const uint64_t back = (range >> 32) - 1;
+            if( victim.compare_exchange_weak(range, packRange(range & 0xFFFFFFFF, back), std::memory_order_acq_rel) )
+            {
+                ++this->deques[workerId].stolenTileCount;
+                tile = back;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void TileScheduler::getOwnTiles(int workerId, size_t& firstTile, size_t& finishTile) const
+{
+    firstTile = this->firstTiles[workerId];
+    finishTile = this->firstTiles[workerId + 1];
+}
+
+const TileScheduler::Tile& TileScheduler::getTile(size_t tile) const
+{
+    return this->tiles[tile];
+}
+
+size_t TileScheduler::getTileCount() const
+{
+    return this->tiles.size();
+}
+
+int TileScheduler::getGridRows() const
+{
+    return this->gridRows;
+}
+
+int TileScheduler::getGridColumns() const
+{
+    return this->gridColumns;
+}
+
+void TileScheduler::addIdleTime(int workerId, long long nanoseconds)
+{
+    this->deques[workerId].idleNanoseconds += nanoseconds;
+}
+
+std::vector<long long> TileScheduler::getStolenTileCounts() const
+{
+    std::vector<long long> counts;
+    for( const WorkerDeque& deque : this->deques )
+        counts.push_back(deque.stolenTileCount);
+    return counts;
+}
+
+std::vector<double> TileScheduler::getIdleSeconds() const
+{
+    std::vector<double> seconds;
+    for( const WorkerDeque& deque : this->deques )
+        seconds.push_back(deque.idleNanoseconds / 1e9);
+    return seconds;
+}
@@ -0,0 +1,144 @@
+#ifndef TILESCHEDULER_H
+#define TILESCHEDULER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Tiles dealt to every worker on each phase, so a worker that falls behind leaves enough of them for the others to steal.
+#define SCHEDULER_TILES_PER_WORKER 8
+// Most cells of a tile, unless a single row is longer. A worker checks for a stop before every tile, so this bounds
+// the time a stop waits for the phases that do not check inside a tile, whatever the size of the matrix.
+#define SCHEDULER_MAXIMUM_TILE_CELLS 65536
+
+/**
+ * Splits the interior of the matrix in one block per worker, and every block in bands of rows, the tiles, that are
+ * dealt to the workers on every phase. Each worker gets the tiles of its own block in its deque and takes them from
+ * the front. A worker whose deque is empty steals from the back of the others, so a core that runs slower only
+ * delays its last tiles instead of the whole generation. A deque is a single word holding its front and back,
+ * and both ends are claimed with a compare and swap, so the owner and the thieves never take the same tile.
+ */
+class TileScheduler
+{
+public:
+    /**
+     * @brief How the interior is split in one block per worker.
+     */
+    enum Decomposition
+    {
+        // Stripes of whole rows, one above the other.
+        ROW_STRIPES,
+        // A grid of rectangles, whose shape follows the aspect ratio of the matrix so the blocks have the
+        // shortest borders, and the workers read the fewest cells of their neighbours.
+        BLOCKS,
+        DECOMPOSITION_COUNT
+    };
+
+    /**
+     * @brief Interior rectangle of a tile, from the start row and column to the cell before the finish ones.
+     */
+    struct Tile
+    {
+        size_t startRow;
+        size_t finishRow;
+        size_t startColumn;
+        size_t finishColumn;
+    };
+
+private:
+    struct alignas(64) WorkerDeque
+    {
+        // The front in the low half, the back in the high half.
+        std::atomic<uint64_t> range;
+        long long stolenTileCount = 0;
+        long long idleNanoseconds = 0;
+    };
+
+    int workerCount = 1;
+    int gridRows = 1;
+    int gridColumns = 1;
+    bool stealing = true;
+    std::vector<Tile> tiles;
+    // The tiles of each worker go from its first tile to the first tile of the next one.
+    std::vector<size_t> firstTiles;
+    std::vector<WorkerDeque> deques;
+
+public:
+    /**
+     * @brief Returns a printable name for the given decomposition.
+     */
+    static const char* getDecompositionName(Decomposition decomposition);
+
+    /**
+     * @brief Chooses how many blocks the rows and the columns are split in, so that their product is the number of
+     * workers and the blocks have the shortest total border.
+     */
+    static void chooseGrid(size_t rowCount, size_t columnCount, int workerCount, int& gridRows, int& gridColumns);
+
+    /**
+     * @brief Splits the interior in tiles and clears the statistics. It must not be called while workers take tiles.
+     * @param rowCount Number of interior rows of the matrix.
+     * @param columnCount Number of interior columns of the matrix.
+     * @param workerCount Number of workers that take tiles.
+     * @param rowMultiple The height of the tiles is rounded up to a multiple of it, so they do not cut the cache
+     * tiles of the workers. Zero or one leaves it as is.
+     * @param decomposition How the interior is split among the workers.
+     * @param stealing false keeps every worker on its own tiles.
+     */
+    void setup(size_t rowCount, size_t columnCount, int workerCount, size_t rowMultiple, Decomposition decomposition, bool stealing);
+
+    /**
+     * @brief Deals every tile again for the next phase. It must be called once all the workers ran out of tiles.
+     */
+    void reset();
+
+    /**
+     * @brief Takes the next tile of the worker, or steals one from another worker if it has none left.
+     * @param tile Index of the tile taken, set only if there was one.
+     * @return false when no worker has tiles left in this phase.
+     */
+    bool takeTile(int workerId, size_t& tile);
+
+    /**
+     * @brief Returns the tiles dealt to the given worker on every phase, from the first one to the one before the finish one.
+     */
+    void getOwnTiles(int workerId, size_t& firstTile, size_t& finishTile) const;
+
+    /**
+     * @brief Returns the rectangle of the given tile.
+     */
+    const Tile& getTile(size_t tile) const;
+
+    /**
+     * @brief Returns the number of tiles the interior is split in.
+     */
+    size_t getTileCount() const;
+
+    /**
+     * @brief Returns how many blocks the rows are split in.
+     */
+    int getGridRows() const;
+
+    /**
+     * @brief Returns how many blocks the columns are split in.
+     */
+    int getGridColumns() const;
+
+    /**
+     * @brief Adds time the worker spent waiting for the others at the end of a phase.
+     */
+    void addIdleTime(int workerId, long long nanoseconds);
+
+    /**
+     * @brief Returns how many tiles each worker took from the deques of the others since setup().
+     */
+    std::vector<long long> getStolenTileCounts() const;
+
+    /**
+     * @brief Returns the seconds each worker spent waiting for the others since setup().
+     */
+    std::vector<double> getIdleSeconds() const;
+};
+
+#endif // TILESCHEDULER_H
@@ -0,0 +1,25 @@
+#include <algorithm>
+
+#include "Transport.h"
+
+bool Transport::allReduceMaximum(double& value)
+{
+    // The first process gathers every value and sends the largest back. The processes of a simulation are few,
+    // so a tree would only save a couple of messages.
+    const int rank = this->getRank();
+    const int processCount = this->getProcessCount();
+    if( rank != 0 )
+        return this->send(0, &value, sizeof(value)) && this->receive(0, &value, sizeof(value));
+
+    for( int peer = 1; peer < processCount; ++peer )
+    {
+        double peerValue = 0.0;
+        if( !this->receive(peer, &peerValue, sizeof(peerValue)) )
+            return false;
+        value = std::max(value, peerValue);
+    }
+    for( int peer = 1; peer < processCount; ++peer )
+        if( !this->send(peer, &value, sizeof(value)) )
+            return false;
+    return true;
+}
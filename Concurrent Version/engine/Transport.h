@@ -0,0 +1,52 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cstddef>
+
+/**
+ * Moves bytes between the processes of a distributed simulation, each one known by its rank. Every message is a
+ * fixed number of bytes that both ends agree on beforehand, so there are no headers, and a call only returns once
+ * the whole message went through. Any failure means a process is gone, and the simulation cannot go on.
+ */
+class Transport
+{
+public:
+    virtual ~Transport() = default;
+
+    /**
+     * @brief Returns the rank of this process, from zero to the number of processes minus one.
+     */
+    virtual int getRank() const = 0;
+
+    /**
+     * @brief Returns the number of processes of the simulation.
+     */
+    virtual int getProcessCount() const = 0;
+
+    /**
+     * @brief Sends the given bytes to the peer.
+     * @return false if the peer could not be reached.
+     */
+    virtual bool send(int peer, const void* data, size_t bytes) = 0;
+
+    /**
+     * @brief Waits until the given number of bytes arrived from the peer.
+     * @return false if the peer could not be reached.
+     */
+    virtual bool receive(int peer, void* data, size_t bytes) = 0;
+
+    /**
+     * @brief Sends and receives the same number of bytes with the peer at once, so two neighbours that exchange
+     * large edges never wait for each other to read first.
+     * @return false if the peer could not be reached.
+     */
+    virtual bool exchange(int peer, const void* sent, void* received, size_t bytes) = 0;
+
+    /**
+     * @brief Replaces the given value with the largest one given by any process. Every process must call it.
+     * @return false if a process could not be reached.
+     */
+    bool allReduceMaximum(double& value);
+};
+
+#endif // TRANSPORT_H
@@ -1,138 +1,107 @@
+#include <QFileInfo>
+
+#include "AutoTuner.h"
 #include "ColorHandler.h"
-#include "FileHandler.h"
+#include "HeatMapEngine.h"
 #include "HeatMapModel.h"
-#include "HeatMapWorker.h"
+#include "TemperatureGrid.h"
 
 HeatMapModel::HeatMapModel(QObject* parent)
     : QThread ()
 {
-    this->fileHandler = new FileHandler(parent);
+    Q_UNUSED(parent)
+    this->engine = new HeatMapEngine();
     this->colorHandler = new ColorHandler();
-    this->previousTemperatureMatrix = new  std::vector< std::vector<double> > ();
-    this->currentTemperatureMatrix = new  std::vector< std::vector<double> > ();
+    // A missing profile just leaves the default configuration.
+    this->autoTuner = new AutoTuner();
+    this->autoTuner->loadProfile( AutoTuner::getDefaultProfilePath() );
+    this->baseline = AutoTuner::capture(*this->engine);
 }
 
 HeatMapModel::~HeatMapModel()
 {
-    delete this->previousTemperatureMatrix;
-    delete this->currentTemperatureMatrix;
+    delete this->autoTuner;
     delete this->colorHandler;
-    delete this->fileHandler;
+    delete this->engine;
 }
 
 void HeatMapModel::run()
 {
-    this->simulateHeatExchange();
-    this->exec();
+    if( this->engine->run() )
+        emit simulationDone();
 }
 
 void HeatMapModel::fillTemperatureMatrix(const QString &fileDirectory)
 {
-    if( !this->previousTemperatureMatrix->empty() )
-        this->previousTemperatureMatrix->clear();
-    this->fileHandler->processFile(fileDirectory,*this->previousTemperatureMatrix);
-    *this->currentTemperatureMatrix = *previousTemperatureMatrix;
+    this->checkpointLoaded = fileDirectory.endsWith(CHECKPOINT_EXTENSION, Qt::CaseInsensitive) && this->engine->loadCheckpoint( fileDirectory.toStdString() );
+    if( !this->checkpointLoaded )
+        this->engine->loadFile( fileDirectory.toStdString() );
+
+    // A simulation started from a file writes its checkpoints beside it, and one resumed goes on writing the same one.
+    const QFileInfo fileInfo(fileDirectory);
+    this->checkpointPath.clear();
+    if( this->checkpointLoaded )
+        this->checkpointPath = fileDirectory;
+    else if( !fileDirectory.isEmpty() )
+        this->checkpointPath = fileInfo.path() + "/" + fileInfo.completeBaseName() + CHECKPOINT_EXTENSION;
+    this->engine->setCheckpointing( this->checkpointPath.toStdString(), CHECKPOINT_DEFAULT_INTERVAL );
+    AutoTuner::Configuration configuration;
+    if( this->autoTuner->findConfiguration( this->engine->getNumberOfRows(), this->engine->getNumberOfColumns(), configuration ) )
+        AutoTuner::apply(configuration, *this->engine);
+    else
+        AutoTuner::apply(this->baseline, *this->engine);
 }
 
-size_t HeatMapModel::getNumberOfRows() const
+bool HeatMapModel::isCheckpointLoaded() const
 {
-     return this->currentTemperatureMatrix->size();
+    return this->checkpointLoaded;
 }
 
-size_t HeatMapModel::getNumberOfColumns() const
+QString HeatMapModel::getCheckpointPath() const
 {
-     return (*this->currentTemperatureMatrix)[0].size();
+    return this->checkpointPath;
 }
 
-void HeatMapModel::setMaxAndMinTemperature()
+void HeatMapModel::stoptWorkers()
 {
-    this->maximumTemperature = this->minimumTemperature = 0;
-
-    for( size_t row = 0;  row < this->getNumberOfRows(); ++row )
-    {
-        for( size_t column = 0; column < this->getNumberOfColumns(); ++column )
-        {
-            if( (*this->currentTemperatureMatrix)[row][column] > this->maximumTemperature )
-                this->maximumTemperature = (*this->currentTemperatureMatrix)[row][column];
-            if( (*this->currentTemperatureMatrix)[row][column] < this->minimumTemperature )
-                this->minimumTemperature = (*this->currentTemperatureMatrix)[row][column];
-         }
-     }
+    do
+        this->engine->stop();
+    while( !this->wait(STOP_RETRY_MILLISECONDS) );
 }
 
-void HeatMapModel::setEpsilon(double epsilon)
+size_t HeatMapModel::getNumberOfRows() const
 {
-    this->epsilon = epsilon;
+     return this->engine->getNumberOfRows();
 }
 
-
-void HeatMapModel::simulateHeatExchange()
+size_t HeatMapModel::getNumberOfColumns() const
 {
-    this->workers.clear();
-    this->finishedWorkerCount =  0;
-    this->equilibriumState = true;
-
-    int workerCount = qMin( QThread::idealThreadCount(), static_cast<int>(this->getNumberOfRows()) );
-
-    for( int workerId = 0; workerId < workerCount; ++workerId )
-    {
-        HeatMapWorker* worker = new HeatMapWorker{workerId, workerCount, this->epsilon, this->previousTemperatureMatrix, this->currentTemperatureMatrix};
-        this->workers.push_back(worker);
-        this->connect( worker, &HeatMapWorker::temperatureUpdated, this, &HeatMapModel::temperatureUpdateDone );
-        this->connect( this, &HeatMapModel::updateMatrix, worker, &HeatMapWorker::updateTemperatures );
-        this->workers[workerId]->start();
-    }
-     emit updateMatrix();
+     return this->engine->getNumberOfColumns();
 }
 
-void HeatMapModel::temperatureUpdateDone(bool equilibriumState)
+void HeatMapModel::setMaxAndMinTemperature()
 {
+    this->maximumTemperature = this->minimumTemperature = 0;
 
-    if(!equilibriumState)
-        this->equilibriumState = equilibriumState;
-
-    if( ++this->finishedWorkerCount == this->workers.size()-1 )
+    const TemperatureGrid& matrix = this->engine->getResult();
+    for( size_t row = 0;  row < matrix.getNumberOfRows(); ++row )
     {
-        std::vector< std::vector<double> >* temp = this->previousTemperatureMatrix;
-        this->previousTemperatureMatrix = this->currentTemperatureMatrix;
-        this->currentTemperatureMatrix = temp;
-
-        if( this->getEquilibriumState() )
-        {
-            emit simulationDone();
-            for ( HeatMapWorker* worker : this->workers )
-            {
-                worker->exit();
-                worker->deleteLater();
-            }
-        }
-        else
+        for( size_t column = 0; column < matrix.getNumberOfColumns(); ++column )
         {
-            this->equilibriumState = true;
-            this->finishedWorkerCount = 0;
-            emit updateMatrix();
-        }
-    }
-}
-
-void HeatMapModel::stoptWorkers()
-{
-    Q_ASSERT(this->workers.size() > 0);
-
-    for ( HeatMapWorker* worker : this->workers )
-    {
-        worker->exit();
-        worker->deleteLater();
-    }
+            if( matrix(row,column) > this->maximumTemperature )
+                this->maximumTemperature = matrix(row,column);
+            if( matrix(row,column) < this->minimumTemperature )
+                this->minimumTemperature = matrix(row,column);
+         }
+     }
 }
 
-bool HeatMapModel::getEquilibriumState() const
+QColor HeatMapModel::getRGBColor(double temperature) const
 {
-    return this->equilibriumState;
+    return this->colorHandler->getRGBColor(this->minimumTemperature, this->maximumTemperature, temperature);
 }
 
-QColor HeatMapModel::getRGBColor(const size_t &row, const size_t &column) const
+HeatMapEngine * HeatMapModel::getEngine() const
 {
-    return this->colorHandler->getRGBColor(this->minimumTemperature, this->maximumTemperature, (*this->previousTemperatureMatrix)[row][column]);
+    return this->engine;
 }
-
@@ -1,31 +1,36 @@
 #ifndef HEATMAPMODEL_H
 #define HEATMAPMODEL_H
 
+#include <QColor>
 #include <QThread>
 
-class FileHandler;
+#include "AutoTuner.h"
+
+// Milliseconds the model waits for the engine to leave its run before asking it to stop again.
+#define STOP_RETRY_MILLISECONDS 10
+
 class ColorHandler;
-class HeatMapWorker;
+class HeatMapEngine;
 
+/**
+ * @brief Runs the engine in its own thread, so the interface keeps painting its snapshots, and colours them.
+ */
 class HeatMapModel: public QThread
 {
     Q_OBJECT
     Q_DISABLE_COPY(HeatMapModel)
 
 private:
-    double epsilon = 0.0;
     double maximumTemperature = 0.0;
     double minimumTemperature = 0.0;
+    bool checkpointLoaded = false;
+    QString checkpointPath;
 
-    bool equilibriumState = true;
-    std::vector< std::vector<double> > * currentTemperatureMatrix = nullptr;
-    std::vector< std::vector<double> > * previousTemperatureMatrix = nullptr;
-
-    int finishedWorkerCount = 0;
-    std::vector< HeatMapWorker* > workers;
-
-    FileHandler * fileHandler = nullptr;
+    HeatMapEngine * engine = nullptr;
     ColorHandler * colorHandler = nullptr;
+    AutoTuner * autoTuner = nullptr;
+    // Configuration of the engine before any tuned one was applied, used for sizes the profile does not have.
+    AutoTuner::Configuration baseline;
 
 public:
     explicit HeatMapModel(QObject* parent = nullptr);
@@ -33,19 +38,26 @@ public:
     ~HeatMapModel() override;
 
     /**
-     * @brief Calls a method in FileHandler that goes through the .csv file and parses it
-     * into a matrix of doubles.
+     * @brief Loads the .csv or binary grid file into the engine, and applies the tuned configuration for its size if the
+     * profile has one. A checkpoint is loaded with its state, so simulating continues from its generation. The
+     * simulation then writes its checkpoints next to the file, or to the checkpoint itself.
     */
     void fillTemperatureMatrix(const QString& fileDirectory);
 
     /**
-     * @brief Creates and starts the workers.
+     * @brief Returns true if the last file loaded was a checkpoint, whose epsilon and solver are those of the engine.
     */
-    void simulateHeatExchange();
+    bool isCheckpointLoaded() const;
 
     /**
-     * @brief Goes through all the workers that we've created and makes them exit their events queue, and then
-     * deletes them
+     * @brief Returns the checkpoint written by the simulation of the loaded file.
+    */
+    QString getCheckpointPath() const;
+
+    /**
+     * @brief Stops the simulation and waits for the thread to finish. The engine returns after its current phase or
+     * cycle, and simulationDone is not emitted. The engine drops a stop that comes before its run started, so the
+     * stop is repeated until the thread finishes.
     */
     void stoptWorkers();
 
@@ -62,47 +74,28 @@ public:
     size_t getNumberOfColumns() const;
 
     /**
-      * @brief Calculate the maximum and minimum temperatures located in the matrix and return them through pointers.
+      * @brief Calculate the maximum and minimum temperatures located in the loaded matrix.
       */
     void setMaxAndMinTemperature();
 
     /**
-      * @brief Returns true if the temperature matrix reached the equilibrium state and false if it didn't.
-      * @return The equilibrium state of the temperature matrix
-      */
-    bool getEquilibriumState() const;
-
-    /**
-      * @brief Obtains the temperature in the specific position of the matrix and returns its color in RGB format.
-      * @param row Desired row.
-      * @param column Desired column.
+      * @brief Returns the color of the given temperature in RGB format, between the minimum and maximum
+      * temperatures of the loaded matrix.
+      * @param temperature Temperature of a cell, usually taken from a snapshot.
       * @return An RGB color corresponding to the specified temperature.
       */
-    QColor getRGBColor(const size_t &row, const size_t &column) const;
+    QColor getRGBColor(double temperature) const;
 
     /**
-      * @brief Gets the epsilon from epsilonLineEdit
-      * @param epsilonVariation Epsilon value written on epsilonLineEdit.
+      * @brief Returns the engine, to configure the next simulation and read its results.
       */
-    void setEpsilon(double epsilon);
+    HeatMapEngine * getEngine() const;
 
 signals:
     /**
     * @brief emits a signal to MainWindow when the simulation has finished
     */
     void simulationDone();
-
-    /**
-    * @brief emits a signal to HeatMapWorker when a generation has passed
-    */
-    void updateMatrix();
-
-private slots:
-    /**
-      * @brief Recieves a signal from HeatMapWorker when a worker finishes its rows
-    */
-    void temperatureUpdateDone(bool equilibriumState);
 };
 
 #endif // HEATMAPMODEL_H
-
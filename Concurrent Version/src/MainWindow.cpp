@@ -1,3 +1,4 @@
+#include <QCloseEvent>
 #include <QDragEnterEvent>
 #include <QFileDialog>
 #include <QFileInfo>
@@ -6,6 +7,9 @@
 #include <QTimer>
 #include <QTime>
 
+#include "BinaryGridFile.h"
+#include "CheckpointWriter.h"
+#include "HeatMapEngine.h"
 #include "HeatMapModel.h"
 #include "MainWindow.h"
 #include "ui_MainWindow.h"
@@ -47,7 +51,7 @@ void MainWindow::dragMoveEvent(QDragMoveEvent *event)
 void MainWindow::dropEvent(QDropEvent *event)
 {
     QStringList fileTypes;
-    fileTypes << "csv";
+    fileTypes << "csv" << QString(BINARY_GRID_EXTENSION).mid(1) << QString(CHECKPOINT_EXTENSION).mid(1);
 
     QString fileDirectory;
     QList<QUrl> filePath;
@@ -65,10 +69,8 @@ void MainWindow::dropEvent(QDropEvent *event)
             this->heatMapModel->setMaxAndMinTemperature();
             this->paintMatrix();
             this->ui->openFileButton->setDisabled(true);
-            this->ui->epsilonLineEdit->clear();
-            this->ui->epsilonLineEdit->setEnabled(true);
-            this->ui->refreshRatioLineEdit->setEnabled(true);
-            this->ui->statusBar->showMessage( "Rows: " + QString::number(this->heatMapModel->getNumberOfRows()) + " Columns: " + QString::number(this->heatMapModel->getNumberOfColumns()) );
+            this->enableSettings();
+            this->showLoadedFile();
         }
         else
         {
@@ -95,17 +97,15 @@ void MainWindow::on_epsilonLineEdit_textEdited(const QString& argument)
 
 void MainWindow::on_openFileButton_clicked()
 {
-    this->heatMapModel->fillTemperatureMatrix(QFileDialog::getOpenFileName(this,"File Explorer"," ", "CSV Files (*.csv)"));
+    this->heatMapModel->fillTemperatureMatrix(QFileDialog::getOpenFileName(this,"File Explorer"," ", "Grid Files (*.csv *" BINARY_GRID_EXTENSION " *" CHECKPOINT_EXTENSION ")"));
     this->heatMapModel->setMaxAndMinTemperature();
     this->paintMatrix();
 
-    this->ui->epsilonLineEdit->clear();
-    this->ui->epsilonLineEdit->setEnabled(true);
-    this->ui->refreshRatioLineEdit->setEnabled(true);
+    this->enableSettings();
 
     this->ui->openFileButton->setDisabled(true);
 
-    this->ui->statusBar->showMessage( "Rows: " + QString::number(this->heatMapModel->getNumberOfRows()) + " Columns: " + QString::number(this->heatMapModel->getNumberOfColumns()) );
+    this->showLoadedFile();
 }
 
 void MainWindow::on_simulateButton_clicked()
@@ -115,8 +115,10 @@ void MainWindow::on_simulateButton_clicked()
     this->ui->simulateButton->setDisabled(true);
     this->ui->epsilonLineEdit->setDisabled(true);
     this->ui->refreshRatioLineEdit->setDisabled(true);
+    this->ui->solverComboBox->setDisabled(true);
 
-    this->heatMapModel->setEpsilon( this->ui->epsilonLineEdit->text().toDouble() );
+    this->heatMapModel->getEngine()->setEpsilon( this->ui->epsilonLineEdit->text().toDouble() );
+    this->heatMapModel->getEngine()->setSolver( static_cast<Solver>(this->ui->solverComboBox->currentIndex()) );
 
     bool ok(false);
     int refreshRatio = 0;
@@ -131,8 +133,9 @@ void MainWindow::on_simulateButton_clicked()
 
     this->ui->statusBar->showMessage("Stabilizing...");
 
-    this->connect( this->heatMapModel, &HeatMapModel::simulationDone, this, &MainWindow::simulation_finished );
-    this->connect( this->timer, &QTimer::timeout, this, &MainWindow::update_interface );
+    // A stopped simulation is resumed by simulating again, so the signals may already be connected.
+    this->connect( this->heatMapModel, &HeatMapModel::simulationDone, this, &MainWindow::simulation_finished, Qt::UniqueConnection );
+    this->connect( this->timer, &QTimer::timeout, this, &MainWindow::update_interface, Qt::UniqueConnection );
 
     this->timeElapsed->start();
 
@@ -143,15 +146,33 @@ void MainWindow::on_simulateButton_clicked()
 void MainWindow::on_stopButton_clicked()
 {
     this->timer->stop();
+    // The workers stop within a band of rows, so waiting for them does not freeze the interface.
     this->heatMapModel->stoptWorkers();
+    const size_t generation = this->paintMatrix();
 
     this->ui->openFileButton->setEnabled(true);
     this->ui->stopButton->setDisabled(true);
+    this->ui->simulateButton->setEnabled(true);
+    this->ui->epsilonLineEdit->setEnabled(true);
+    this->ui->refreshRatioLineEdit->setEnabled(true);
+    this->ui->solverComboBox->setEnabled(true);
 
     QString simDuration = QString::number(this->timeElapsed->elapsed()/1000.0);
-    this->ui->statusBar->showMessage("Simulation stopped after "+ simDuration +" seconds");
+    QString stopLatency = QString::number(this->heatMapModel->getEngine()->getStopLatency() * 1000.0);
+    this->ui->statusBar->showMessage("Simulation stopped after "+ simDuration +" seconds at generation " + QString::number(generation)
+                                     + " in " + stopLatency + " ms, simulate again to resume it. " + this->saveCheckpoint());
+}
 
-    this->heatMapModel->exit();
+void MainWindow::closeEvent(QCloseEvent *event)
+{
+    // The window waits for the workers, which stop within a band of rows, and for the checkpoint to be written.
+    if( this->heatMapModel->isRunning() )
+    {
+        this->timer->stop();
+        this->heatMapModel->stoptWorkers();
+        this->saveCheckpoint();
+    }
+    QMainWindow::closeEvent(event);
 }
 
 void MainWindow::simulation_finished()
@@ -162,28 +183,79 @@ void MainWindow::simulation_finished()
     this->ui->openFileButton->setEnabled(true);
 
     QString simDuration = QString::number(this->timeElapsed->elapsed()/1000.0);
-    this->ui->statusBar->showMessage("Equilibrium state reached after "+ simDuration +" seconds");
-    this->heatMapModel->exit();
+    QString generationUnit = " generations";
+    if( this->heatMapModel->getEngine()->getSolver() == MULTIGRID_SOLVER )
+        generationUnit = " cycles";
+    else if( this->heatMapModel->getEngine()->getSolver() == CONJUGATE_GRADIENT_SOLVER )
+        generationUnit = " iterations (residual norm " + QString::number(this->heatMapModel->getEngine()->getResidualNorm()) + ")";
+    else if( this->heatMapModel->getEngine()->getSolver() == ASYNCHRONOUS_SOLVER )
+        generationUnit = " sweeps per worker";
+    if( this->heatMapModel->getEngine()->getSolver() == DIRECT_SOLVER )
+        this->ui->statusBar->showMessage("Equilibrium state computed directly in "+ simDuration +" seconds");
+    else
+        this->ui->statusBar->showMessage("Equilibrium state reached after "+ simDuration +" seconds and "
+                                         + QString::number(this->heatMapModel->getEngine()->getGenerationCount()) + generationUnit);
 }
 
 void MainWindow::update_interface()
 {
-    this->paintMatrix();
+    const size_t generation = this->paintMatrix();
+    this->ui->statusBar->showMessage("Stabilizing... generation " + QString::number(generation));
 }
 
-void MainWindow::paintMatrix()
+size_t MainWindow::paintMatrix()
 {
-    QImage heatMapImage(this->heatMapModel->getNumberOfColumns(), this->heatMapModel->getNumberOfRows(), QImage::Format_RGB32);
+    // The snapshot is a complete generation that the simulation no longer writes, so it is painted while it runs.
+    const SnapshotBuffer::Snapshot& snapshot = this->heatMapModel->getEngine()->acquireSnapshot();
+    const TemperatureGrid& matrix = snapshot.matrix;
+    QImage heatMapImage(matrix.getNumberOfColumns(), matrix.getNumberOfRows(), QImage::Format_RGB32);
 
-    for( size_t row = 0; row < this->heatMapModel->getNumberOfRows(); ++row )
+    for( size_t row = 0; row < matrix.getNumberOfRows(); ++row )
     {
-        for( size_t column = 0; column < this->heatMapModel->getNumberOfColumns(); ++column )
+        for( size_t column = 0; column < matrix.getNumberOfColumns(); ++column )
         {
-            heatMapImage.setPixelColor( column, row, this->heatMapModel->getRGBColor(row, column) );
+            heatMapImage.setPixelColor( column, row, this->heatMapModel->getRGBColor(matrix(row, column)) );
         }
     }
-    QPixmap heatPixelMap( this->heatMapModel->getNumberOfRows(), this->heatMapModel->getNumberOfColumns() );
+    QPixmap heatPixelMap( matrix.getNumberOfRows(), matrix.getNumberOfColumns() );
     this->ui->simulationLabel->setScaledContents(true);
     heatPixelMap.convertFromImage(heatMapImage);
     this->ui->simulationLabel->setPixmap(heatPixelMap.scaled(this->ui->simulationLabel->width(), this->ui->simulationLabel->height(), Qt::KeepAspectRatio) );
+    return snapshot.generation;
+}
+
+void MainWindow::enableSettings()
+{
+    this->ui->epsilonLineEdit->clear();
+    if( this->heatMapModel->isCheckpointLoaded() )
+    {
+        // The epsilon is shown with every digit, so the resumed simulation reads back exactly the same one.
+        this->ui->epsilonLineEdit->setText( QString::number(this->heatMapModel->getEngine()->getEpsilon(), 'g', 17) );
+        this->ui->solverComboBox->setCurrentIndex( this->heatMapModel->getEngine()->getSolver() );
+        this->ui->simulateButton->setEnabled(true);
+    }
+    this->ui->epsilonLineEdit->setEnabled(true);
+    this->ui->refreshRatioLineEdit->setEnabled(true);
+    this->ui->solverComboBox->setEnabled(true);
+}
+
+QString MainWindow::saveCheckpoint()
+{
+    // An in-place solver stopped within a generation keeps the last checkpoint written while it ran.
+    HeatMapEngine * engine = this->heatMapModel->getEngine();
+    const bool saved = engine->saveCheckpoint();
+    if( !saved && engine->getCheckpointGeneration() == 0 )
+        return "No checkpoint could be written";
+    return QString(saved ? "Checkpoint" : "Last checkpoint") + " of generation " + QString::number(static_cast<qulonglong>( engine->getCheckpointGeneration() ))
+            + " in " + this->heatMapModel->getCheckpointPath();
+}
+
+void MainWindow::showLoadedFile()
+{
+    const HeatMapEngine * engine = this->heatMapModel->getEngine();
+    QString message = "Rows: " + QString::number(this->heatMapModel->getNumberOfRows()) + " Columns: " + QString::number(this->heatMapModel->getNumberOfColumns())
+            + " Loaded at " + QString::number(engine->getLoadThroughput(), 'f', 1) + " MB/s";
+    if( engine->getRaggedRowCount() > 0 )
+        message += " (" + QString::number(static_cast<qulonglong>( engine->getRaggedRowCount() )) + " rows padded or truncated)";
+    this->ui->statusBar->showMessage(message);
 }
@@ -24,11 +24,36 @@ public:
 
 private:
     /**
-    * @brief Paints the current state of currentMatrix.
+    * @brief Paints the newest snapshot published by the model.
+    * @return The generation of the snapshot.
     */
-    void paintMatrix();
+    size_t paintMatrix();
+
+    /**
+    * @brief Shows the size of the loaded file in the status bar, how fast it was parsed, and how many of its rows
+    * were padded or truncated.
+    */
+    void showLoadedFile();
+
+    /**
+    * @brief Enables the settings of the simulation once a file is loaded, filled with the epsilon and the solver of
+    * a checkpoint when one was loaded, so it can be resumed right away.
+    */
+    void enableSettings();
+
+    /**
+    * @brief Writes a checkpoint of the stopped simulation and describes it.
+    * @return A message saying which generation the checkpoint holds.
+    */
+    QString saveCheckpoint();
 
 protected:
+    /**
+     * @brief Stops a running simulation and writes a checkpoint before the window closes, so it can be resumed.
+     * @param event Event of closing the window.
+     */
+    virtual void closeEvent(QCloseEvent *event);
+
     /**
      * @brief Detects the file entering the window while dragged.
      * @param event Event of dragging in the file.
@@ -52,7 +77,8 @@ protected:
 
 private slots:
     /**
-      * @brief Allows the user to select a .csv file from the file browser, which contains floating point values.
+      * @brief Allows the user to select a .csv or binary grid file from the file browser, which contains floating point
+      * values, or a checkpoint to resume.
       */
     void on_openFileButton_clicked();
 
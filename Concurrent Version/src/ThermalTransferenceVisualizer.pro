@@ -22,26 +22,36 @@ DEFINES += QT_DEPRECATED_WARNINGS
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
-CONFIG += c++11
+CONFIG += c++17
 
 SOURCES += \
-    HeatMapWorker.cpp \
         main.cpp \
         MainWindow.cpp \
-    FileHandler.cpp \
     ColorHandler.cpp \
     HeatMapModel.cpp
 
 HEADERS += \
-    HeatMapWorker.h \
         MainWindow.h \
-    FileHandler.h \
     ColorHandler.h \
     HeatMapModel.h
 
 FORMS += \
         MainWindow.ui
 
+# The simulation runs in the engine library, this project is only a front end.
+INCLUDEPATH += ../engine
+DEPENDPATH += ../engine
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../engine/release/ -lHeatMapEngine
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../engine/debug/ -lHeatMapEngine
+else:unix: LIBS += -L$$OUT_PWD/../engine/ -lHeatMapEngine
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../engine/release/libHeatMapEngine.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../engine/debug/libHeatMapEngine.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../engine/release/HeatMapEngine.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../engine/debug/HeatMapEngine.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../engine/libHeatMapEngine.a
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cmath>
+
 #include "HeatMapModel.h"
 #include "FileHandler.h"
 
@@ -10,6 +13,7 @@ void HeatMapModel::fillTemperatureMatrix(const QString &filePath)
 {
     if(!this->previousTemperatureMatrix.empty())
         this->previousTemperatureMatrix.clear();
+    this->currentTemperatureMatrix.clear();
     this->fileHandler->processFile(filePath,this->previousTemperatureMatrix);
 }
 
@@ -40,36 +44,28 @@ void HeatMapModel::setMaxAndMinTemperature()
 }
 void HeatMapModel:: updateTemperatureMatrix()
 {
-    this->isStabilized = true;
-    double temporalValue;
-    std::vector<double> temporalVector = {};
-    for( size_t row = 0; row < this->getNumberOfRows(); ++row )
+    // The border never changes, so the current matrix only needs a copy of it once, and the sweep
+    // covers the interior rectangle without asking for every cell whether it is on the edge.
+    if( this->currentTemperatureMatrix.size() != this->previousTemperatureMatrix.size() )
+        this->currentTemperatureMatrix = this->previousTemperatureMatrix;
+
+    double maximumVariation = 0.0;
+    for( size_t row = 1; row + 1 < this->getNumberOfRows(); ++row )
     {
-        temporalVector.clear();
-        for( size_t column = 0; column < this->getNumberOfColumns(); ++column )
+        for( size_t column = 1; column + 1 < this->getNumberOfColumns(); ++column )
         {
-            temporalValue = 0.0;
-            if( this->isBorder(row,column) )
-            {
-                temporalValue = previousTemperatureMatrix[row][column];
-            }
-            else
-            {
-                temporalValue = this->getNewTemperature(row,column);
-
-                if( abs(  temporalValue - previousTemperatureMatrix[row][column] ) > this->epsilonVariation )
-                    this->isStabilized = false;
-            }
-            temporalVector.push_back(temporalValue);
+            const double temporalValue = this->getNewTemperature(row,column);
+            maximumVariation = std::max( maximumVariation, std::abs( temporalValue - previousTemperatureMatrix[row][column] ) );
+            currentTemperatureMatrix[row][column] = temporalValue;
         }
-        currentTemperatureMatrix.push_back(temporalVector);
     }
+    this->isStabilized = maximumVariation <= this->epsilonVariation;
 }
 
 void HeatMapModel::updatePreviousTemperatureMatrix()
 {
-    this->previousTemperatureMatrix = this->currentTemperatureMatrix;
-    this->currentTemperatureMatrix.clear();
+    // Both matrices share the same border, so exchanging them is enough to start the next generation.
+    this->previousTemperatureMatrix.swap(this->currentTemperatureMatrix);
 }
 
 double HeatMapModel::getNewTemperature(const size_t &row, const size_t &column) const
@@ -97,11 +93,6 @@ bool HeatMapModel::equilibriumStateReached() const
     return this->isStabilized;
 }
 
-bool HeatMapModel::isBorder(const size_t row, const size_t col) const
-{
-    return (row == 0 || col == 0 || row == this->getNumberOfRows()-1 || col == this->getNumberOfColumns()-1 );
-}
-
 void HeatMapModel::setEpsilon(double temperatureVariation)
 {
     this->epsilonVariation = temperatureVariation;
@@ -59,6 +59,7 @@ public:
 
     /**
       * @brief Set the previous temperature matrix as the current one, in order to calculate the new values of the current one.
+      * Both matrices are exchanged instead of copied, since they share the same border.
       */
     void updatePreviousTemperatureMatrix();
 
@@ -96,14 +97,6 @@ private:
       * @return The average of the neighboring temperatures.
       */
     double getNewTemperature(const size_t &row, const size_t &column) const;
-
-    /**
-      * @brief Determines whether a specified position in the matrix is at the edges.
-      * @param row Desired row.
-      * @param column Desired column.
-      * @return True if the specified position is at the edge.
-      */
-    bool isBorder(const size_t row, const size_t col) const;
 };
 
 #endif // HEATMAPMODEL_H
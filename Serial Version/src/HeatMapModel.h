@@ -53,6 +53,7 @@ public:
 
     /**
       * @brief Set the previous temperature matrix as the current one, in order to calculate the new values of the current one.
+      * Both matrices are exchanged instead of copied, since they share the same border.
       */
     void updatePreviousTemperatureMatrix();
 
@@ -62,14 +63,6 @@ public:
       */
     bool equilibriumStateReached() const;
 
-    /**
-      * @brief Determines whether a specified position in the matrix is at the edges.
-      * @param row Desired row.
-      * @param column Desired column.
-      * @return True if the specified position is at the edge.
-      */
-    bool isBorder(const size_t row, const size_t col) const;
-
     /**
       * @brief Obtains the temperature in the specific position of the matrix and returns its color in RGB format.
       * @param row Desired row.